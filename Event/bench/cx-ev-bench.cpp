@@ -0,0 +1,525 @@
+﻿/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// dispatch 경로 microbenchmark (Google Benchmark)
+// JSON 출력: cx-ev-bench --benchmark_format=json
+//            cx-ev-bench --benchmark_out=result.json --benchmark_out_format=json
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+#include "../ev/pch.hpp"
+
+#include <benchmark/benchmark.h>
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+#include "../ev/cx-ev.hpp"
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+using namespace cx;
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace bench
+{
+	class Payload : public ev::EventData
+	{
+	public:
+		std::int64_t _Value;
+
+	public:
+		explicit Payload(std::int64_t const value) :
+			_Value(value)
+		{
+		}
+	};
+
+	struct PayloadData
+	{
+		std::int64_t value;
+	};
+
+	using PayloadChanged = ev::TypedEvent<1, PayloadData>;
+	using PayloadCleared = ev::TypedEvent<2, PayloadData>;
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// 한 EventType 에 handler 가 N 개
+static void BM_KeyNotifyEvent(benchmark::State& state)
+{
+	std::size_t const count = static_cast<std::size_t>(state.range(0));
+
+	std::uint64_t hits = 0;
+	ev::key::EventDispatcher eventDispatcher;
+	for (std::size_t i = 0; i < count; i++)
+	{
+		eventDispatcher.registerEventHandler(1, i, [&hits](ev::Event&) { hits++; });
+	}
+
+	for (auto _ : state)
+	{
+		ev::Event event{ 1 };
+		eventDispatcher.notifyEvent(1, event);
+	}
+	benchmark::DoNotOptimize(hits);
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+BENCHMARK(BM_KeyNotifyEvent)->RangeMultiplier(10)->Range(1, 100000);
+
+static void BM_TargetNotifyEvent(benchmark::State& state)
+{
+	std::size_t const count = static_cast<std::size_t>(state.range(0));
+
+	std::uint64_t hits = 0;
+	auto eventTarget = std::make_shared<int>(0);
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	for (std::size_t i = 0; i < count; i++)
+	{
+		eventHandlerRegistry.registerEventHandler(1, eventTarget, [&hits](ev::Event&) { hits++; });
+	}
+
+	for (auto _ : state)
+	{
+		ev::Event event{ 1 };
+		eventDispatcher.notifyEvent(1, eventTarget, event);
+	}
+	benchmark::DoNotOptimize(hits);
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+BENCHMARK(BM_TargetNotifyEvent)->RangeMultiplier(10)->Range(1, 100000);
+
+static void BM_StaticNotifyEvent(benchmark::State& state)
+{
+	std::size_t const count = static_cast<std::size_t>(state.range(0));
+
+	std::uint64_t hits = 0;
+	ev::key::StaticEventDispatcher<bench::PayloadChanged, bench::PayloadCleared> eventDispatcher;
+	for (std::size_t i = 0; i < count; i++)
+	{
+		eventDispatcher.registerEventHandler<bench::PayloadChanged>(i, [&hits](bench::PayloadData const&) { hits++; });
+	}
+
+	std::int64_t value = 0;
+	for (auto _ : state)
+	{
+		eventDispatcher.notifyEvent<bench::PayloadChanged>(bench::PayloadData{ value++ });
+	}
+	benchmark::DoNotOptimize(hits);
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+BENCHMARK(BM_StaticNotifyEvent)->RangeMultiplier(10)->Range(1, 100000);
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// EventType (또는 EventTarget) N 개에 handler 가 하나씩, 돌아가며 통지
+static void BM_KeyNotifyEventTypes(benchmark::State& state)
+{
+	auto const count = static_cast<ev::EventType>(state.range(0));
+
+	std::uint64_t hits = 0;
+	ev::key::EventDispatcher eventDispatcher;
+	for (ev::EventType eventType = 0; eventType < count; eventType++)
+	{
+		eventDispatcher.registerEventHandler(eventType, 1, [&hits](ev::Event&) { hits++; });
+	}
+
+	ev::EventType eventType = 0;
+	for (auto _ : state)
+	{
+		ev::Event event{ eventType };
+		eventDispatcher.notifyEvent(eventType, event);
+		eventType = (eventType + 1 == count) ? 0 : eventType + 1;
+	}
+	benchmark::DoNotOptimize(hits);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KeyNotifyEventTypes)->RangeMultiplier(10)->Range(1, 10000);
+
+static void BM_TargetNotifyEventTargets(benchmark::State& state)
+{
+	std::size_t const count = static_cast<std::size_t>(state.range(0));
+
+	std::uint64_t hits = 0;
+	std::vector<ev::target::EventTarget> eventTargets;
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	for (std::size_t i = 0; i < count; i++)
+	{
+		eventTargets.push_back(std::make_shared<int>(0));
+		eventHandlerRegistry.registerEventHandler(1, eventTargets.back(), [&hits](ev::Event&) { hits++; });
+	}
+
+	std::size_t index = 0;
+	for (auto _ : state)
+	{
+		ev::Event event{ 1 };
+		eventDispatcher.notifyEvent(1, eventTargets[index], event);
+		index = (index + 1 == count) ? 0 : index + 1;
+	}
+	benchmark::DoNotOptimize(hits);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TargetNotifyEventTargets)->RangeMultiplier(10)->Range(1, 10000);
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// 이미 N 개가 등록된 상태에서 등록/해제 한 쌍
+static void BM_KeyRegisterUnregister(benchmark::State& state)
+{
+	std::size_t const count = static_cast<std::size_t>(state.range(0));
+
+	ev::key::EventDispatcher eventDispatcher;
+	for (std::size_t i = 0; i < count; i++)
+	{
+		eventDispatcher.registerEventHandler(static_cast<ev::EventType>(i % 64), i, [](ev::Event&) {});
+	}
+
+	ev::key::Key const key = count;
+	for (auto _ : state)
+	{
+		eventDispatcher.registerEventHandler(1, key, [](ev::Event&) {});
+		eventDispatcher.unregisterEventHandler(key);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KeyRegisterUnregister)->RangeMultiplier(10)->Range(1, 100000);
+
+static void BM_TargetRegisterUnregister(benchmark::State& state)
+{
+	std::size_t const count = static_cast<std::size_t>(state.range(0));
+
+	std::vector<ev::target::EventTarget> eventTargets;
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	for (std::size_t i = 0; i < count; i++)
+	{
+		eventTargets.push_back(std::make_shared<int>(0));
+		eventHandlerRegistry.registerEventHandler(1, eventTargets.back(), [](ev::Event&) {});
+	}
+
+	auto eventTarget = std::make_shared<int>(0);
+	for (auto _ : state)
+	{
+		eventHandlerRegistry.registerEventHandler(1, eventTarget, [](ev::Event&) {});
+		eventHandlerRegistry.unregisterEventHandler(eventTarget);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TargetRegisterUnregister)->RangeMultiplier(10)->Range(1, 100000);
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// payload 전달 비용
+static void BM_PayloadMakeShared(benchmark::State& state)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	eventDispatcher.registerEventHandler(1, 1, [](ev::Event&) {});
+
+	std::int64_t value = 0;
+	for (auto _ : state)
+	{
+		eventDispatcher.notifyEvent(1, std::make_shared<bench::Payload>(value++));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PayloadMakeShared);
+
+static void BM_PayloadMakeEventData(benchmark::State& state)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	eventDispatcher.registerEventHandler(1, 1, [](ev::Event&) {});
+
+	std::int64_t value = 0;
+	for (auto _ : state)
+	{
+		eventDispatcher.notifyEvent(1, ev::makeEventData<bench::Payload>(value++));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PayloadMakeEventData);
+
+static void BM_PayloadTypedEvent(benchmark::State& state)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	eventDispatcher.registerEventHandler(bench::PayloadChanged::eventType, 1, ev::makeEventHandler<bench::PayloadChanged>([](bench::PayloadData const&) {}));
+
+	std::int64_t value = 0;
+	for (auto _ : state)
+	{
+		eventDispatcher.notifyEvent<bench::PayloadChanged>(bench::PayloadData{ value++ });
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PayloadTypedEvent);
+
+static void BM_PayloadFrameArena(benchmark::State& state)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	eventDispatcher.registerEventHandler(bench::PayloadChanged::eventType, 1, ev::makeEventHandler<bench::PayloadChanged>([](bench::PayloadData const&) {}));
+
+	ev::FrameArena frameArena;
+	std::int64_t value = 0;
+	for (auto _ : state)
+	{
+		auto& payload = frameArena.create<bench::PayloadData>(bench::PayloadData{ value++ });
+		eventDispatcher.notifyEvent<bench::PayloadChanged>(payload);
+		if ((value & 1023) == 0)
+		{
+			frameArena.reset();
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PayloadFrameArena);
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// 한 tick 에 EventTarget 64 개마다 같은 이벤트가 N 번씩 몰려 들어옴
+static void BM_TargetBurstNotifyEvent(benchmark::State& state)
+{
+	std::size_t const burst = static_cast<std::size_t>(state.range(0));
+
+	std::uint64_t hits = 0;
+	std::vector<ev::target::EventTarget> eventTargets;
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	for (std::size_t i = 0; i < 64; i++)
+	{
+		eventTargets.push_back(std::make_shared<int>(0));
+		eventHandlerRegistry.registerEventHandler(1, eventTargets.back(), [&hits](ev::Event&) { hits++; });
+	}
+
+	std::int64_t value = 0;
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < burst; i++)
+		{
+			for (auto const& eventTarget : eventTargets)
+			{
+				eventDispatcher.notifyEvent(1, eventTarget, ev::makeEventData<bench::Payload>(value++));
+			}
+		}
+	}
+	benchmark::DoNotOptimize(hits);
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(burst * eventTargets.size()));
+}
+BENCHMARK(BM_TargetBurstNotifyEvent)->RangeMultiplier(10)->Range(1, 1000);
+
+static void BM_TargetBurstCoalescer(benchmark::State& state)
+{
+	std::size_t const burst = static_cast<std::size_t>(state.range(0));
+
+	std::uint64_t hits = 0;
+	std::vector<ev::target::EventTarget> eventTargets;
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	ev::target::EventCoalescer eventCoalescer{ eventDispatcher };
+	for (std::size_t i = 0; i < 64; i++)
+	{
+		eventTargets.push_back(std::make_shared<int>(0));
+		eventHandlerRegistry.registerEventHandler(1, eventTargets.back(), [&hits](ev::Event&) { hits++; });
+	}
+
+	std::int64_t value = 0;
+	for (auto _ : state)
+	{
+		for (std::size_t i = 0; i < burst; i++)
+		{
+			for (auto const& eventTarget : eventTargets)
+			{
+				eventCoalescer.postEvent(1, eventTarget, ev::makeEventData<bench::Payload>(value++));
+			}
+		}
+		eventCoalescer.flush();
+	}
+	benchmark::DoNotOptimize(hits);
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(burst * eventTargets.size()));
+}
+BENCHMARK(BM_TargetBurstCoalescer)->RangeMultiplier(10)->Range(1, 1000);
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// 한 frame 동안 EventTarget 64 개에 두 종류의 TypedEvent 가 번갈아 들어옴
+static void BM_TargetFrameNotifyEvent(benchmark::State& state)
+{
+	std::uint64_t hits = 0;
+	std::vector<ev::target::EventTarget> eventTargets;
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	for (std::size_t i = 0; i < 64; i++)
+	{
+		eventTargets.push_back(std::make_shared<int>(0));
+		eventHandlerRegistry.registerEventHandler<bench::PayloadChanged>(eventTargets.back(), [&hits](bench::PayloadData const& payload) { hits += payload.value; });
+		eventHandlerRegistry.registerEventHandler<bench::PayloadCleared>(eventTargets.back(), [&hits](bench::PayloadData const& payload) { hits -= payload.value; });
+	}
+
+	std::int64_t value = 0;
+	for (auto _ : state)
+	{
+		for (auto const& eventTarget : eventTargets)
+		{
+			eventDispatcher.notifyEvent<bench::PayloadChanged>(eventTarget, bench::PayloadData{ value++ });
+			eventDispatcher.notifyEvent<bench::PayloadCleared>(eventTarget, bench::PayloadData{ value++ });
+		}
+	}
+	benchmark::DoNotOptimize(hits);
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(eventTargets.size() * 2));
+}
+BENCHMARK(BM_TargetFrameNotifyEvent);
+
+static void BM_TargetFrameDeferredEventQueue(benchmark::State& state)
+{
+	std::uint64_t hits = 0;
+	std::vector<ev::target::EventTarget> eventTargets;
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	ev::target::DeferredEventQueue deferredEventQueue{ eventDispatcher, static_cast<ev::DeferredEventOrder>(state.range(0)) };
+	for (std::size_t i = 0; i < 64; i++)
+	{
+		eventTargets.push_back(std::make_shared<int>(0));
+		eventHandlerRegistry.registerEventHandler<bench::PayloadChanged>(eventTargets.back(), [&hits](bench::PayloadData const& payload) { hits += payload.value; });
+		eventHandlerRegistry.registerEventHandler<bench::PayloadCleared>(eventTargets.back(), [&hits](bench::PayloadData const& payload) { hits -= payload.value; });
+	}
+
+	std::int64_t value = 0;
+	for (auto _ : state)
+	{
+		for (auto const& eventTarget : eventTargets)
+		{
+			deferredEventQueue.postEvent<bench::PayloadChanged>(eventTarget, bench::PayloadData{ value++ });
+			deferredEventQueue.postEvent<bench::PayloadCleared>(eventTarget, bench::PayloadData{ value++ });
+		}
+		deferredEventQueue.processQueue();
+	}
+	benchmark::DoNotOptimize(hits);
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(eventTargets.size() * 2));
+}
+BENCHMARK(BM_TargetFrameDeferredEventQueue)
+	->Arg(static_cast<std::int64_t>(ev::DeferredEventOrder::Posted))
+	->Arg(static_cast<std::int64_t>(ev::DeferredEventOrder::GroupedByType));
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// 여러 thread 에서 동시에 통지
+static ev::key::ConcurrentEventDispatcher* _KeyConcurrentEventDispatcher{ nullptr };
+
+static void BM_KeyConcurrentNotifyEvent(benchmark::State& state)
+{
+	if (state.thread_index() == 0)
+	{
+		_KeyConcurrentEventDispatcher = new ev::key::ConcurrentEventDispatcher();
+		for (ev::key::Key key = 0; key < 16; key++)
+		{
+			_KeyConcurrentEventDispatcher->registerEventHandler(1, key, [](ev::Event&) {});
+		}
+	}
+
+	for (auto _ : state)
+	{
+		ev::Event event{ 1 };
+		_KeyConcurrentEventDispatcher->notifyEvent(1, event);
+	}
+	state.SetItemsProcessed(state.iterations());
+
+	if (state.thread_index() == 0)
+	{
+		delete _KeyConcurrentEventDispatcher;
+		_KeyConcurrentEventDispatcher = nullptr;
+	}
+}
+BENCHMARK(BM_KeyConcurrentNotifyEvent)->ThreadRange(1, 8)->UseRealTime();
+
+static ev::target::ConcurrentEventDispatcher* _TargetConcurrentEventDispatcher{ nullptr };
+static std::vector<ev::target::EventTarget> _TargetConcurrentEventTargets;
+
+static void BM_TargetConcurrentNotifyEvent(benchmark::State& state)
+{
+	if (state.thread_index() == 0)
+	{
+		_TargetConcurrentEventDispatcher = new ev::target::ConcurrentEventDispatcher();
+		_TargetConcurrentEventTargets.clear();
+		for (int i = 0; i < state.threads(); i++)
+		{
+			_TargetConcurrentEventTargets.push_back(std::make_shared<int>(i));
+			_TargetConcurrentEventDispatcher->registerEventHandler(1, _TargetConcurrentEventTargets.back(), [](ev::Event&) {});
+		}
+	}
+
+	for (auto _ : state)
+	{
+		ev::Event event{ 1 };
+		_TargetConcurrentEventDispatcher->notifyEvent(1, _TargetConcurrentEventTargets[state.thread_index()], event);
+	}
+	state.SetItemsProcessed(state.iterations());
+
+	if (state.thread_index() == 0)
+	{
+		delete _TargetConcurrentEventDispatcher;
+		_TargetConcurrentEventDispatcher = nullptr;
+	}
+}
+BENCHMARK(BM_TargetConcurrentNotifyEvent)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_MakeEventDataConcurrent(benchmark::State& state)
+{
+	std::int64_t value = 0;
+	for (auto _ : state)
+	{
+		auto eventData = ev::makeEventData<bench::Payload>(value++);
+		benchmark::DoNotOptimize(eventData);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MakeEventDataConcurrent)->ThreadRange(1, 8)->UseRealTime();
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+BENCHMARK_MAIN();
+
+
+
+
@@ -0,0 +1,146 @@
+﻿/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+#include "pch.hpp"
+
+#include "cx-ev.hpp"
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	AsyncEventQueue::AsyncEventQueue(
+		PostedEventHandler const& postedEventHandler,
+		std::size_t const workerCount,
+		std::size_t const capacity,
+		BackpressurePolicy const backpressurePolicy
+	) :
+		_PostedEventHandler(postedEventHandler),
+		_BackpressurePolicy(backpressurePolicy),
+		_PostedEvents(capacity ? capacity : 1)
+	{
+		std::size_t const count = workerCount ? workerCount : 1;
+		_Workers.reserve(count);
+		for (std::size_t i = 0; i < count; i++)
+		{
+			_Workers.emplace_back(&AsyncEventQueue::run, this);
+		}
+	}
+	AsyncEventQueue::~AsyncEventQueue()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_Mutex);
+			_Stopped = true;
+		}
+		_NotEmpty.notify_all();
+		_NotFull.notify_all();
+
+		for (auto& worker : _Workers)
+		{
+			worker.join();
+		}
+	}
+	bool AsyncEventQueue::post(PostedEvent&& postedEvent)
+	{
+		std::unique_lock<std::mutex> lock(_Mutex);
+
+		std::size_t const capacity = _PostedEvents.size();
+		if (_Count == capacity)
+		{
+			switch (_BackpressurePolicy)
+			{
+			case BackpressurePolicy::Block:
+				_NotFull.wait(lock,
+					[this, capacity]()
+					{
+						return _Stopped || _Count < capacity;
+					}
+				);
+				break;
+
+			case BackpressurePolicy::DropOldest:
+				_PostedEvents[_Head] = PostedEvent{};
+				_Head = (_Head + 1) % capacity;
+				_Count--;
+				_Outstanding--;
+				_DroppedCount++;
+				break;
+
+			case BackpressurePolicy::Reject:
+				_DroppedCount++;
+				return false;
+			}
+		}
+		if (_Stopped)
+		{
+			return false;
+		}
+
+		_PostedEvents[(_Head + _Count) % capacity] = std::move(postedEvent);
+		_Count++;
+		_Outstanding++;
+		lock.unlock();
+
+		_NotEmpty.notify_one();
+		return true;
+	}
+	void AsyncEventQueue::flush()
+	{
+		std::unique_lock<std::mutex> lock(_Mutex);
+		_Idle.wait(lock,
+			[this]()
+			{
+				return _Outstanding == 0;
+			}
+		);
+	}
+	std::size_t AsyncEventQueue::droppedCount()
+	{
+		std::lock_guard<std::mutex> lock(_Mutex);
+		return _DroppedCount;
+	}
+	void AsyncEventQueue::run()
+	{
+		std::size_t const capacity = _PostedEvents.size();
+		while (true)
+		{
+			PostedEvent postedEvent;
+			{
+				std::unique_lock<std::mutex> lock(_Mutex);
+				_NotEmpty.wait(lock,
+					[this]()
+					{
+						return _Stopped || _Count != 0;
+					}
+				);
+				if (_Count == 0)
+				{
+					return;
+				}
+
+				postedEvent = std::move(_PostedEvents[_Head]);
+				_Head = (_Head + 1) % capacity;
+				_Count--;
+			}
+			_NotFull.notify_one();
+
+			_PostedEventHandler(postedEvent);
+
+			{
+				std::lock_guard<std::mutex> lock(_Mutex);
+				_Outstanding--;
+				if (_Outstanding == 0)
+				{
+					_Idle.notify_all();
+				}
+			}
+		}
+	}
+}
+
+
+
+
@@ -0,0 +1,200 @@
+﻿#pragma once
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// 큐가 가득 찼을 때 postEvent 의 동작
+	enum class BackpressurePolicy
+	{
+		Block,      // 빈 자리가 생길 때까지 대기
+		DropOldest, // 가장 오래된 이벤트를 버리고 넣음
+		Reject      // 넣지 않고 false 반환
+	};
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	class PostedEvent
+	{
+	public:
+		EventType _EventType{ 0 };
+		std::shared_ptr<void> _EventTarget;
+		std::shared_ptr<EventData> _EventData;
+	};
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// 고정 크기 MPMC 큐 + worker thread pool
+	// worker 는 꺼낸 PostedEvent 를 생성 시 받은 handler 로 처리
+	class AsyncEventQueue
+	{
+	public:
+		using PostedEventHandler = Delegate<void(PostedEvent&)>;
+
+	private:
+		PostedEventHandler _PostedEventHandler;
+		BackpressurePolicy _BackpressurePolicy;
+
+		std::mutex _Mutex;
+		std::condition_variable _NotEmpty;
+		std::condition_variable _NotFull;
+		std::condition_variable _Idle;
+
+		std::vector<PostedEvent> _PostedEvents;
+		std::size_t _Head{ 0 };
+		std::size_t _Count{ 0 };
+		std::size_t _Outstanding{ 0 };
+		std::size_t _DroppedCount{ 0 };
+		bool _Stopped{ false };
+
+		std::vector<std::thread> _Workers;
+
+	public:
+		AsyncEventQueue(
+			PostedEventHandler const& postedEventHandler,
+			std::size_t const workerCount,
+			std::size_t const capacity,
+			BackpressurePolicy const backpressurePolicy
+		);
+
+	public:
+		~AsyncEventQueue();
+
+	public:
+		AsyncEventQueue(AsyncEventQueue const&) = delete;
+		AsyncEventQueue& operator=(AsyncEventQueue const&) = delete;
+
+	public:
+		bool post(PostedEvent&& postedEvent);
+		// 지금까지 post 된 이벤트가 모두 처리(또는 폐기)될 때까지 대기, worker thread 안에서 호출하면 안 됨
+		void flush();
+		std::size_t droppedCount();
+
+	private:
+		void run();
+	};
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::key
+{
+	// postEvent 는 큐에 넣고 바로 반환, worker thread 가 TEventDispatcher::notifyEvent 를 호출
+	// 기본은 ConcurrentEventDispatcher: 다른 thread 에서 등록/해제해도 worker 의 통지와 충돌하지 않음
+	// EventDispatcher 를 넘기면 worker 는 하나만 허용되고, AsyncEventDispatcher 가 살아 있는 동안 등록/해제하면 안 됨
+	template<typename TEventDispatcher = ConcurrentEventDispatcher>
+	class AsyncEventDispatcher
+	{
+	private:
+		AsyncEventQueue _AsyncEventQueue;
+
+	public:
+		AsyncEventDispatcher(
+			TEventDispatcher& eventDispatcher,
+			std::size_t const workerCount = 1,
+			std::size_t const capacity = 1024,
+			BackpressurePolicy const backpressurePolicy = BackpressurePolicy::Block
+		) :
+			_AsyncEventQueue(
+				[&eventDispatcher](PostedEvent& postedEvent)
+				{
+					eventDispatcher.notifyEvent(postedEvent._EventType, std::move(postedEvent._EventData));
+				},
+				workerCount,
+				capacity,
+				backpressurePolicy
+			)
+		{
+			assert((std::is_same_v<TEventDispatcher, ConcurrentEventDispatcher> || workerCount <= 1) && "EventDispatcher is not thread-safe");
+		}
+
+	public:
+		bool postEvent(EventType const eventType, std::shared_ptr<EventData> eventData)
+		{
+			return _AsyncEventQueue.post(PostedEvent{ eventType, nullptr, std::move(eventData) });
+		}
+		void flush()
+		{
+			_AsyncEventQueue.flush();
+		}
+		std::size_t droppedCount()
+		{
+			return _AsyncEventQueue.droppedCount();
+		}
+	};
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	// postEvent 는 큐에 넣고 바로 반환, worker thread 가 TEventDispatcher::notifyEvent 를 호출
+	// 기본은 ConcurrentEventDispatcher: 다른 thread 에서 등록/해제해도 worker 의 통지와 충돌하지 않음
+	// EventDispatcher 를 넘기면 worker 는 하나만 허용되고, AsyncEventDispatcher 가 살아 있는 동안 등록/해제하면 안 됨
+	template<typename TEventDispatcher = ConcurrentEventDispatcher>
+	class AsyncEventDispatcher
+	{
+	private:
+		AsyncEventQueue _AsyncEventQueue;
+
+	public:
+		AsyncEventDispatcher(
+			TEventDispatcher& eventDispatcher,
+			std::size_t const workerCount = 1,
+			std::size_t const capacity = 1024,
+			BackpressurePolicy const backpressurePolicy = BackpressurePolicy::Block
+		) :
+			_AsyncEventQueue(
+				[&eventDispatcher](PostedEvent& postedEvent)
+				{
+					eventDispatcher.notifyEvent(postedEvent._EventType, postedEvent._EventTarget, std::move(postedEvent._EventData));
+				},
+				workerCount,
+				capacity,
+				backpressurePolicy
+			)
+		{
+			assert((std::is_same_v<TEventDispatcher, ConcurrentEventDispatcher> || workerCount <= 1) && "EventDispatcher is not thread-safe");
+		}
+
+	public:
+		bool postEvent(EventType const eventType, EventTarget const& eventTarget, std::shared_ptr<EventData> eventData)
+		{
+			return _AsyncEventQueue.post(PostedEvent{ eventType, eventTarget, std::move(eventData) });
+		}
+		void flush()
+		{
+			_AsyncEventQueue.flush();
+		}
+		std::size_t droppedCount()
+		{
+			return _AsyncEventQueue.droppedCount();
+		}
+	};
+}
+
+
+
+
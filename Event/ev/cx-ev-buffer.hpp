@@ -0,0 +1,83 @@
+﻿#pragma once
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// 버퍼 두 벌을 번갈아 쓰는 post/처리 큐의 공통 부분 (EventCoalescer, DeferredEventQueue)
+	// - post 는 posting() 버퍼에 쌓음
+	// - ProcessScope 는 posting 버퍼를 처리용으로 넘기고 다른 버퍼를 posting 으로 바꿈, 처리 중(handler 안)에 post 된 것은 다음 처리로 넘어감
+	// - ProcessScope 가 끝나면 (handler 가 예외를 던져도) 처리한 버퍼를 clear() 하고 처리 중 표시를 내림
+	// - TBuffer 는 empty(), clear() 가 있어야 하고, clear() 가 용량을 유지하면 평소에는 할당 없음
+	template<typename TBuffer>
+	class DoubleBuffer
+	{
+	public:
+		class ProcessScope
+		{
+		private:
+			DoubleBuffer& _DoubleBuffer;
+			TBuffer& _Buffer;
+
+		public:
+			explicit ProcessScope(DoubleBuffer& doubleBuffer) :
+				_DoubleBuffer(doubleBuffer),
+				_Buffer(doubleBuffer._Buffers[doubleBuffer._Posting])
+			{
+				_DoubleBuffer._Processing = true;
+				_DoubleBuffer._Posting ^= 1;
+			}
+			~ProcessScope()
+			{
+				_Buffer.clear();
+				_DoubleBuffer._Processing = false;
+			}
+
+		public:
+			ProcessScope(ProcessScope const&) = delete;
+			ProcessScope& operator=(ProcessScope const&) = delete;
+
+		public:
+			TBuffer& buffer() const
+			{
+				return _Buffer;
+			}
+		};
+
+	private:
+		std::array<TBuffer, 2> _Buffers;
+		std::size_t _Posting{ 0 };
+		bool _Processing{ false };
+
+	public:
+		// 두 버퍼 모두 TBuffer(args...) 로 만듦
+		template<typename... Args>
+		explicit DoubleBuffer(Args const&... args) :
+			_Buffers{ TBuffer(args...), TBuffer(args...) }
+		{
+		}
+
+	public:
+		DoubleBuffer(DoubleBuffer const&) = delete;
+		DoubleBuffer& operator=(DoubleBuffer const&) = delete;
+
+	public:
+		TBuffer& posting()
+		{
+			return _Buffers[_Posting];
+		}
+		TBuffer const& posting() const
+		{
+			return _Buffers[_Posting];
+		}
+		// 처리 중이 아니고 쌓인 것이 있으면 true, 처리 안에서 다시 처리하지 않도록 ProcessScope 전에 확인
+		bool ready() const
+		{
+			return !_Processing && !posting().empty();
+		}
+	};
+}
+
+
+
+
@@ -0,0 +1,183 @@
+﻿/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+#include "pch.hpp"
+
+#include "cx-ev.hpp"
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::key
+{
+	bool EventCoalescer::Buffer::empty() const
+	{
+		return _PendingEvents.empty();
+	}
+	void EventCoalescer::Buffer::clear()
+	{
+		_Events.clear();
+		_PendingEvents.clear();
+	}
+	EventCoalescer::EventCoalescer(EventDispatcher& eventDispatcher) :
+		_EventDispatcher(eventDispatcher)
+	{
+	}
+	void EventCoalescer::setEventDataMerger(EventType const eventType, EventDataMerger const& eventDataMerger)
+	{
+		if (eventDataMerger)
+		{
+			_EventDataMergers[eventType] = eventDataMerger;
+		}
+		else
+		{
+			_EventDataMergers.erase(eventType);
+		}
+	}
+	void EventCoalescer::postEvent(EventType const eventType, std::shared_ptr<EventData> eventData)
+	{
+		auto pendingEventIndex = _PendingEventIndices.find(eventType);
+		auto& pendingEvents = _Buffers.posting()._PendingEvents;
+		if (!pendingEventIndex)
+		{
+			_PendingEventIndices[eventType] = pendingEvents.size();
+			pendingEvents.push_back({ eventType, std::move(eventData) });
+			return;
+		}
+
+		auto& pendingEvent = pendingEvents[*pendingEventIndex];
+		auto eventDataMerger = _EventDataMergers.find(eventType);
+		if (eventDataMerger)
+		{
+			(*eventDataMerger)(pendingEvent._EventData, eventData);
+		}
+		else
+		{
+			pendingEvent._EventData = std::move(eventData);
+		}
+		_CoalescedCount++;
+	}
+	std::size_t EventCoalescer::flush()
+	{
+		if (!_Buffers.ready())
+		{
+			return 0;
+		}
+
+		// handler 안에서 post 된 이벤트는 다른 버퍼에 쌓임
+		DoubleBuffer<Buffer>::ProcessScope processScope{ _Buffers };
+		_PendingEventIndices.clear();
+
+		auto& buffer = processScope.buffer();
+		for (auto& pendingEvent : buffer._PendingEvents)
+		{
+			buffer._Events.emplace_back(pendingEvent._EventType, pendingEvent._EventData);
+		}
+		_EventDispatcher.notifyEvents(buffer._Events);
+
+		return buffer._PendingEvents.size();
+	}
+	std::size_t EventCoalescer::pendingCount() const
+	{
+		return _Buffers.posting()._PendingEvents.size();
+	}
+	std::size_t EventCoalescer::coalescedCount() const
+	{
+		return _CoalescedCount;
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	bool EventCoalescer::Buffer::empty() const
+	{
+		return _PendingEvents.empty();
+	}
+	void EventCoalescer::Buffer::clear()
+	{
+		_Events.clear();
+		_EventTargets.clear();
+		_PendingEvents.clear();
+	}
+	EventCoalescer::EventCoalescer(EventDispatcher& eventDispatcher) :
+		_EventDispatcher(eventDispatcher)
+	{
+	}
+	void EventCoalescer::setEventDataMerger(EventType const eventType, EventDataMerger const& eventDataMerger)
+	{
+		if (eventDataMerger)
+		{
+			_EventDataMergers[eventType] = eventDataMerger;
+		}
+		else
+		{
+			_EventDataMergers.erase(eventType);
+		}
+	}
+	void EventCoalescer::postEvent(EventType const eventType, EventTarget const& eventTarget, std::shared_ptr<EventData> eventData)
+	{
+		EventKey const eventKey{ eventType, eventTarget.get() };
+
+		auto pendingEventIndex = _PendingEventIndices.find(eventKey);
+		auto& pendingEvents = _Buffers.posting()._PendingEvents;
+		if (!pendingEventIndex)
+		{
+			_PendingEventIndices[eventKey] = pendingEvents.size();
+			pendingEvents.push_back({ eventType, eventTarget, std::move(eventData) });
+			return;
+		}
+
+		auto& pendingEvent = pendingEvents[*pendingEventIndex];
+		auto eventDataMerger = _EventDataMergers.find(eventType);
+		if (eventDataMerger)
+		{
+			(*eventDataMerger)(pendingEvent._EventData, eventData);
+		}
+		else
+		{
+			pendingEvent._EventData = std::move(eventData);
+		}
+		_CoalescedCount++;
+	}
+	std::size_t EventCoalescer::flush()
+	{
+		if (!_Buffers.ready())
+		{
+			return 0;
+		}
+
+		// handler 안에서 post 된 이벤트는 다른 버퍼에 쌓임
+		DoubleBuffer<Buffer>::ProcessScope processScope{ _Buffers };
+		_PendingEventIndices.clear();
+
+		auto& buffer = processScope.buffer();
+		for (auto& pendingEvent : buffer._PendingEvents)
+		{
+			buffer._EventTargets.push_back(pendingEvent._EventTarget);
+			buffer._Events.emplace_back(pendingEvent._EventType, pendingEvent._EventData);
+		}
+		_EventDispatcher.notifyEvents(buffer._EventTargets, buffer._Events);
+
+		return buffer._PendingEvents.size();
+	}
+	std::size_t EventCoalescer::pendingCount() const
+	{
+		return _Buffers.posting()._PendingEvents.size();
+	}
+	std::size_t EventCoalescer::coalescedCount() const
+	{
+		return _CoalescedCount;
+	}
+}
+
+
+
+
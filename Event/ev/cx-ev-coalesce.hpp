@@ -0,0 +1,141 @@
+﻿#pragma once
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// 아직 통지하지 않은 pendingEventData 에 새로 post 된 eventData 를 합침
+	// 예) 변화량 누적, 최소/최대 유지. pendingEventData 를 바꾸거나 새 EventData 로 교체
+	using EventDataMerger = Delegate<void(std::shared_ptr<EventData>& pendingEventData, std::shared_ptr<EventData> const& eventData)>;
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::key
+{
+	// 한 tick 동안 post 된 이벤트를 EventType 별로 하나로 합쳐 두었다가 flush() 에서 한 번에 통지
+	// - 합치는 방법은 EventType 별 EventDataMerger, 없으면 마지막 EventData 만 남김
+	// - flush() 는 EventType 이 처음 post 된 순서로 EventDispatcher::notifyEvents 에 넘김
+	// - flush() 중(handler 안)에 post 된 이벤트는 다음 flush() 에서 통지
+	class EventCoalescer
+	{
+	private:
+		struct PendingEvent
+		{
+			EventType _EventType;
+			std::shared_ptr<EventData> _EventData;
+		};
+
+		// notifyEvents 에 넘길 배열도 버퍼마다 두어 통지가 끝나면 (예외여도) 함께 비움
+		struct Buffer
+		{
+			std::vector<PendingEvent> _PendingEvents;
+			std::vector<Event> _Events;
+
+			bool empty() const;
+			void clear();
+		};
+
+	private:
+		EventDispatcher& _EventDispatcher;
+		FlatHashMap<EventType, EventDataMerger> _EventDataMergers;
+
+		// 크기는 tick 마다 재사용
+		FlatHashMap<EventType, std::size_t> _PendingEventIndices;
+		DoubleBuffer<Buffer> _Buffers;
+
+		std::size_t _CoalescedCount{ 0 };
+
+	public:
+		explicit EventCoalescer(EventDispatcher& eventDispatcher);
+
+	public:
+		EventCoalescer(EventCoalescer const&) = delete;
+		EventCoalescer& operator=(EventCoalescer const&) = delete;
+
+	public:
+		// 빈 eventDataMerger 는 마지막 EventData 만 남기는 기본 동작으로 되돌림
+		void setEventDataMerger(EventType const eventType, EventDataMerger const& eventDataMerger);
+		void postEvent(EventType const eventType, std::shared_ptr<EventData> eventData);
+		// tick 마다 한 번 호출, 통지한 이벤트 수 반환. flush() 안에서 다시 호출하면 아무것도 하지 않음
+		std::size_t flush();
+
+	public:
+		std::size_t pendingCount() const;
+		// 합쳐져서 따로 통지되지 않은 이벤트의 누적 수
+		std::size_t coalescedCount() const;
+	};
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	// 한 tick 동안 post 된 이벤트를 (EventType, EventTarget) 별로 하나로 합쳐 두었다가 flush() 에서 한 번에 통지
+	// - 합치는 방법은 EventType 별 EventDataMerger, 없으면 마지막 EventData 만 남김
+	// - flush() 는 (EventType, EventTarget) 이 처음 post 된 순서로 EventDispatcher::notifyEvents 에 넘김
+	// - flush() 중(handler 안)에 post 된 이벤트는 다음 flush() 에서 통지
+	// - EventTarget 은 flush() 까지 강한 참조로 보관
+	class EventCoalescer
+	{
+	private:
+		struct PendingEvent
+		{
+			EventType _EventType;
+			EventTarget _EventTarget;
+			std::shared_ptr<EventData> _EventData;
+		};
+
+		// notifyEvents 에 넘길 배열도 버퍼마다 두어 통지가 끝나면 (예외여도) 함께 비움
+		struct Buffer
+		{
+			std::vector<PendingEvent> _PendingEvents;
+			std::vector<EventTarget> _EventTargets;
+			std::vector<Event> _Events;
+
+			bool empty() const;
+			void clear();
+		};
+
+	private:
+		EventDispatcher& _EventDispatcher;
+		FlatHashMap<EventType, EventDataMerger> _EventDataMergers;
+
+		// 크기는 tick 마다 재사용
+		FlatHashMap<EventKey, std::size_t, EventKeyHash> _PendingEventIndices;
+		DoubleBuffer<Buffer> _Buffers;
+
+		std::size_t _CoalescedCount{ 0 };
+
+	public:
+		explicit EventCoalescer(EventDispatcher& eventDispatcher);
+
+	public:
+		EventCoalescer(EventCoalescer const&) = delete;
+		EventCoalescer& operator=(EventCoalescer const&) = delete;
+
+	public:
+		// 빈 eventDataMerger 는 마지막 EventData 만 남기는 기본 동작으로 되돌림
+		void setEventDataMerger(EventType const eventType, EventDataMerger const& eventDataMerger);
+		void postEvent(EventType const eventType, EventTarget const& eventTarget, std::shared_ptr<EventData> eventData);
+		// tick 마다 한 번 호출, 통지한 이벤트 수 반환. flush() 안에서 다시 호출하면 아무것도 하지 않음
+		std::size_t flush();
+
+	public:
+		std::size_t pendingCount() const;
+		// 합쳐져서 따로 통지되지 않은 이벤트의 누적 수
+		std::size_t coalescedCount() const;
+	};
+}
+
+
+
+
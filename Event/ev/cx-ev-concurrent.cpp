@@ -0,0 +1,359 @@
+﻿/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+#include "pch.hpp"
+
+#include "cx-ev.hpp"
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::key
+{
+	void ConcurrentEventDispatcher::registerEventHandler(EventType const eventType, Key const key, EventHandler const& eventHandler)
+	{
+		shardOf(eventType)._EventHandlerTable.update(
+			[&](EventHandlerTable& eventHandlerTable)
+			{
+				auto& eventHandlers = eventHandlerTable[eventType];
+
+				auto next = eventHandlers ? std::allocate_shared<EventHandlerList>(PoolAllocator<EventHandlerList>{}, *eventHandlers) : std::allocate_shared<EventHandlerList>(PoolAllocator<EventHandlerList>{});
+				auto it = std::find_if(next->begin(), next->end(),
+					[key](EventHandlerEntry const& entry)
+					{
+						return entry._Key == key;
+					}
+				);
+				if (it != next->end())
+				{
+					it->_EventHandler = eventHandler;
+				}
+				else
+				{
+					next->push_back({ key, eventHandler });
+				}
+
+				eventHandlers = std::move(next);
+				return true;
+			}
+		);
+	}
+	void ConcurrentEventDispatcher::unregisterEventHandler(EventType const eventType, Key const key)
+	{
+		shardOf(eventType)._EventHandlerTable.update(
+			[&](EventHandlerTable& eventHandlerTable)
+			{
+				auto eventHandlers = eventHandlerTable.find(eventType);
+				if (!eventHandlers || !*eventHandlers)
+				{
+					return false;
+				}
+
+				auto next = std::allocate_shared<EventHandlerList>(PoolAllocator<EventHandlerList>{});
+				for (auto const& entry : **eventHandlers)
+				{
+					if (entry._Key != key)
+					{
+						next->push_back(entry);
+					}
+				}
+				if (next->size() == (*eventHandlers)->size())
+				{
+					return false;
+				}
+
+				if (next->empty())
+				{
+					eventHandlerTable.erase(eventType);
+				}
+				else
+				{
+					*eventHandlers = std::move(next);
+				}
+				return true;
+			}
+		);
+	}
+	void ConcurrentEventDispatcher::unregisterEventHandler(Key const key)
+	{
+		for (auto& shard : _Shards)
+		{
+			shard._EventHandlerTable.update(
+				[&](EventHandlerTable& eventHandlerTable)
+				{
+					bool changed = false;
+					std::vector<EventType> eventTypes;
+					eventHandlerTable.forEach(
+						[&](EventType const eventType, std::shared_ptr<EventHandlerList const>& eventHandlers)
+						{
+							if (!eventHandlers)
+							{
+								return;
+							}
+
+							auto next = std::allocate_shared<EventHandlerList>(PoolAllocator<EventHandlerList>{});
+							for (auto const& entry : *eventHandlers)
+							{
+								if (entry._Key != key)
+								{
+									next->push_back(entry);
+								}
+							}
+							if (next->size() == eventHandlers->size())
+							{
+								return;
+							}
+
+							changed = true;
+							if (next->empty())
+							{
+								eventTypes.push_back(eventType);
+							}
+							else
+							{
+								eventHandlers = std::move(next);
+							}
+						}
+					);
+					for (auto const eventType : eventTypes)
+					{
+						eventHandlerTable.erase(eventType);
+					}
+					return changed;
+				}
+			);
+		}
+	}
+	void ConcurrentEventDispatcher::synchronize()
+	{
+		for (auto& shard : _Shards)
+		{
+			shard._EventHandlerTable.synchronize();
+		}
+	}
+	void ConcurrentEventDispatcher::dispatchEvent(EventType const eventType, Event& event)
+	{
+		CX_EV_INSTRUMENT_DISPATCH(eventType, nullptr, 1);
+
+		auto snapshot = shardOf(eventType)._EventHandlerTable.read();
+
+		auto eventHandlers = snapshot->find(eventType);
+		if (!eventHandlers || !*eventHandlers)
+		{
+			return;
+		}
+
+		for (auto const& entry : **eventHandlers)
+		{
+			{
+				CX_EV_INSTRUMENT_HANDLER();
+				entry._EventHandler(event);
+			}
+			if (event.handled())
+			{
+				break;
+			}
+		}
+	}
+	void ConcurrentEventDispatcher::notifyEvent(EventType const eventType, Event& event)
+	{
+		dispatchEvent(eventType, event);
+	}
+	void ConcurrentEventDispatcher::notifyEvent(EventType const eventType, std::shared_ptr<EventData> eventData)
+	{
+		Event event{ eventType, eventData };
+		notifyEvent(eventType, event);
+	}
+	ConcurrentEventDispatcher::Shard& ConcurrentEventDispatcher::shardOf(EventType const eventType)
+	{
+		return _Shards[static_cast<std::size_t>(eventType) % ShardCount];
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	ConcurrentEventDispatcher::Token ConcurrentEventDispatcher::registerEventHandler(EventType const eventType, EventTarget const& eventTarget, EventHandler const& eventHandler)
+	{
+		Token const token = _CurrentToken.fetch_add(1, std::memory_order_relaxed) + 1;
+
+		auto& shard = shardOf(eventTarget.get());
+		shard._EventHandlerTable.update(
+			[&](EventHandlerTable& eventHandlerTable)
+			{
+				auto& entry = eventHandlerTable[EventKey{ eventType, eventTarget.get() }];
+				if (entry._EventTarget.expired())
+				{
+					// 같은 주소를 재사용한 이전 객체의 handler 는 버림
+					entry._EventHandlers.reset();
+				}
+
+				auto next = entry._EventHandlers ? std::allocate_shared<EventHandlerList>(PoolAllocator<EventHandlerList>{}, *entry._EventHandlers) : std::allocate_shared<EventHandlerList>(PoolAllocator<EventHandlerList>{});
+				next->push_back({ token, eventHandler });
+
+				entry._EventTarget = eventTarget;
+				entry._EventHandlers = std::move(next);
+
+				// 통지 중에는 지우지 않으므로 소멸된 EventTarget 의 항목은 등록할 때 함께 정리하여 메모리를 제한
+				if (eventHandlerTable.size() >= shard._SweepThreshold)
+				{
+					eraseExpiredEntries(eventHandlerTable);
+					shard._SweepThreshold = std::max<std::size_t>(64, eventHandlerTable.size() * 2);
+				}
+				return true;
+			}
+		);
+		return token;
+	}
+	void ConcurrentEventDispatcher::unregisterEventHandler(EventType const eventType, EventTarget const& eventTarget, Token const token)
+	{
+		shardOf(eventTarget.get())._EventHandlerTable.update(
+			[&](EventHandlerTable& eventHandlerTable)
+			{
+				EventKey const eventKey{ eventType, eventTarget.get() };
+
+				auto entry = eventHandlerTable.find(eventKey);
+				if (!entry || !entry->_EventHandlers)
+				{
+					return false;
+				}
+
+				auto next = std::allocate_shared<EventHandlerList>(PoolAllocator<EventHandlerList>{});
+				for (auto const& eventHandler : *entry->_EventHandlers)
+				{
+					if (eventHandler._Token != token)
+					{
+						next->push_back(eventHandler);
+					}
+				}
+				if (next->size() == entry->_EventHandlers->size())
+				{
+					return false;
+				}
+
+				if (next->empty())
+				{
+					eventHandlerTable.erase(eventKey);
+				}
+				else
+				{
+					entry->_EventHandlers = std::move(next);
+				}
+				return true;
+			}
+		);
+	}
+	void ConcurrentEventDispatcher::unregisterEventHandler(EventTarget const& eventTarget)
+	{
+		shardOf(eventTarget.get())._EventHandlerTable.update(
+			[&](EventHandlerTable& eventHandlerTable)
+			{
+				std::vector<EventKey> eventKeys;
+				eventHandlerTable.forEach(
+					[&](EventKey const& eventKey, EventHandlerTableEntry const&)
+					{
+						if (eventKey.eventTarget == eventTarget.get())
+						{
+							eventKeys.push_back(eventKey);
+						}
+					}
+				);
+				for (auto const& eventKey : eventKeys)
+				{
+					eventHandlerTable.erase(eventKey);
+				}
+				return !eventKeys.empty();
+			}
+		);
+	}
+	void ConcurrentEventDispatcher::dispatchEvent(EventType const eventType, void const* eventTarget, Event& event)
+	{
+		CX_EV_INSTRUMENT_DISPATCH(eventType, eventTarget, 1);
+
+		auto snapshot = shardOf(eventTarget)._EventHandlerTable.read();
+
+		auto entry = snapshot->find(EventKey{ eventType, eventTarget });
+		if (!entry || !entry->_EventHandlers || entry->_EventTarget.expired())
+		{
+			return;
+		}
+
+		for (auto const& eventHandler : *entry->_EventHandlers)
+		{
+			{
+				CX_EV_INSTRUMENT_HANDLER();
+				eventHandler._EventHandler(event);
+			}
+			if (event.handled())
+			{
+				break;
+			}
+		}
+	}
+	void ConcurrentEventDispatcher::notifyEvent(EventType const eventType, EventTarget const& eventTarget, Event& event)
+	{
+		dispatchEvent(eventType, eventTarget.get(), event);
+	}
+	void ConcurrentEventDispatcher::notifyEvent(EventType const eventType, EventTarget const& eventTarget, std::shared_ptr<EventData> eventData)
+	{
+		Event event{ eventType, eventData };
+		notifyEvent(eventType, eventTarget, event);
+	}
+	void ConcurrentEventDispatcher::synchronize()
+	{
+		for (auto& shard : _Shards)
+		{
+			shard._EventHandlerTable.synchronize();
+		}
+	}
+	std::size_t ConcurrentEventDispatcher::sweep()
+	{
+		std::size_t count = 0;
+		for (auto& shard : _Shards)
+		{
+			shard._EventHandlerTable.update(
+				[&count](EventHandlerTable& eventHandlerTable)
+				{
+					std::size_t const erased = eraseExpiredEntries(eventHandlerTable);
+					count += erased;
+					return erased != 0;
+				}
+			);
+		}
+		return count;
+	}
+	ConcurrentEventDispatcher::Shard& ConcurrentEventDispatcher::shardOf(void const* eventTarget)
+	{
+		auto const address = reinterpret_cast<std::uintptr_t>(eventTarget);
+		return _Shards[((address >> 4) ^ (address >> 12)) % ShardCount];
+	}
+	std::size_t ConcurrentEventDispatcher::eraseExpiredEntries(EventHandlerTable& eventHandlerTable)
+	{
+		std::vector<EventKey> eventKeys;
+		eventHandlerTable.forEach(
+			[&eventKeys](EventKey const& eventKey, EventHandlerTableEntry const& entry)
+			{
+				if (entry._EventTarget.expired())
+				{
+					eventKeys.push_back(eventKey);
+				}
+			}
+		);
+		for (auto const& eventKey : eventKeys)
+		{
+			eventHandlerTable.erase(eventKey);
+		}
+		return eventKeys.size();
+	}
+}
+
+
+
+
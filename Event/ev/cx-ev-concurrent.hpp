@@ -0,0 +1,365 @@
+﻿#pragma once
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// RCU 방식 snapshot 게시
+	// - 읽기: thread 마다 정해진 slot 의 reader 계수 증가 + 포인터 읽기 (wait-free, 잠금 없음)
+	//   slot 은 cache line 마다 따로 두어 thread 가 많아도 한 계수를 두고 경합하지 않음
+	// - 쓰기: 잠금 안에서 복사-수정-게시, 복사 비용은 T 크기에 비례하므로 큰 표는 여러 SnapshotCell 로 나눠 담음
+	// - 회수: reader 계수를 phase 두 벌로 나눠, 새 reader 는 지금 phase 로 들어가고 이전 phase 가 비면 phase 를 넘김
+	//   phase 를 두 번 넘긴 뒤에는 그 전에 교체된 snapshot 을 보는 reader 가 없으므로 회수
+	//   읽기가 끊이지 않아도 회수가 진행되고, 쌓이는 snapshot 은 가장 긴 읽기 동안의 update 수로 제한됨
+	// - synchronize(): 호출 전에 시작된 read() 가 모두 끝날 때까지 기다림
+	//   update 로 떼어낸 값이 가리키던 외부 상태는 synchronize() 뒤에 정리해야 함
+	template<typename T>
+	class SnapshotCell
+	{
+	public:
+		static constexpr std::size_t SlotCount = 16;
+
+	private:
+		struct alignas(64) Slot
+		{
+			std::array<std::atomic<std::size_t>, 2> _Readers{};
+		};
+
+		struct RetiredSnapshot
+		{
+			T const* _Snapshot;
+			std::size_t _Epoch;
+		};
+
+	public:
+		class ReadGuard
+		{
+		private:
+			SnapshotCell& _SnapshotCell;
+			std::atomic<std::size_t>& _Readers;
+			T const* _Snapshot;
+
+		public:
+			explicit ReadGuard(SnapshotCell& snapshotCell) :
+				_SnapshotCell(snapshotCell),
+				_Readers(snapshotCell._Slots[threadSlot()]._Readers[snapshotCell._Epoch.load(std::memory_order_acquire) & 1])
+			{
+				_Readers.fetch_add(1, std::memory_order_seq_cst);
+				_Snapshot = _SnapshotCell._Current.load(std::memory_order_seq_cst);
+			}
+			~ReadGuard()
+			{
+				if (_Readers.fetch_sub(1, std::memory_order_release) == 1)
+				{
+					if (_SnapshotCell._RetiredPending.load(std::memory_order_relaxed))
+					{
+						_SnapshotCell.tryReclaim();
+					}
+				}
+			}
+
+		public:
+			ReadGuard(ReadGuard const&) = delete;
+			ReadGuard& operator=(ReadGuard const&) = delete;
+
+		public:
+			T const& operator*() const
+			{
+				return *_Snapshot;
+			}
+			T const* operator->() const
+			{
+				return _Snapshot;
+			}
+		};
+
+	private:
+		std::atomic<T const*> _Current;
+		std::array<Slot, SlotCount> _Slots;
+		// 새 reader 가 들어갈 phase 는 _Epoch & 1, 잠금 안에서만 증가
+		std::atomic<std::size_t> _Epoch{ 0 };
+		std::atomic<bool> _RetiredPending{ false };
+		std::mutex _Mutex;
+		std::vector<RetiredSnapshot> _Retired;
+
+	public:
+		SnapshotCell() :
+			_Current(new T())
+		{
+		}
+
+	public:
+		~SnapshotCell()
+		{
+			for (auto const& retiredSnapshot : _Retired)
+			{
+				delete retiredSnapshot._Snapshot;
+			}
+			delete _Current.load();
+		}
+
+	public:
+		SnapshotCell(SnapshotCell const&) = delete;
+		SnapshotCell& operator=(SnapshotCell const&) = delete;
+
+	public:
+		ReadGuard read()
+		{
+			return ReadGuard(*this);
+		}
+
+		// mutate(T&) 가 true 를 반환하면 새 snapshot 을 게시
+		template<typename Mutate>
+		void update(Mutate&& mutate)
+		{
+			std::lock_guard<std::mutex> lock(_Mutex);
+
+			auto next = std::make_unique<T>(*_Current.load(std::memory_order_relaxed));
+			if (!mutate(*next))
+			{
+				return;
+			}
+
+			T const* previous = _Current.exchange(next.release(), std::memory_order_seq_cst);
+			_Retired.push_back({ previous, _Epoch.load(std::memory_order_relaxed) });
+			_RetiredPending.store(true, std::memory_order_relaxed);
+			reclaim();
+		}
+
+		// 호출 전에 시작된 read() 가 모두 끝날 때까지 기다리고, 그 전에 교체된 snapshot 을 회수
+		// ReadGuard 를 가진 thread 에서 (handler 안에서) 호출하면 끝나지 않음
+		void synchronize()
+		{
+			std::size_t epoch;
+			{
+				std::lock_guard<std::mutex> lock(_Mutex);
+				epoch = _Epoch.load(std::memory_order_relaxed) + 2;
+			}
+
+			// 기다리는 동안 잠금을 잡고 있지 않으므로 handler 안의 update 를 막지 않음
+			while (true)
+			{
+				{
+					std::lock_guard<std::mutex> lock(_Mutex);
+					reclaim();
+					if (epoch <= _Epoch.load(std::memory_order_relaxed))
+					{
+						return;
+					}
+				}
+				std::this_thread::yield();
+			}
+		}
+
+	private:
+		static std::size_t threadSlot()
+		{
+			static std::atomic<std::size_t> lastSlot{ 0 };
+			thread_local std::size_t const slot = lastSlot.fetch_add(1, std::memory_order_relaxed) % SlotCount;
+			return slot;
+		}
+
+	private:
+		void tryReclaim()
+		{
+			std::unique_lock<std::mutex> lock(_Mutex, std::try_to_lock);
+			if (lock.owns_lock())
+			{
+				reclaim();
+			}
+		}
+		bool drained(std::size_t const phase) const
+		{
+			for (auto const& slot : _Slots)
+			{
+				if (slot._Readers[phase].load(std::memory_order_seq_cst) != 0)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		void reclaim()
+		{
+			// 이전 phase 의 reader 가 모두 나갔으면 phase 를 넘김, reader 가 없으면 한 번에 두 번 넘겨 바로 회수
+			for (std::size_t i = 0; i < 2; i++)
+			{
+				std::size_t const epoch = _Epoch.load(std::memory_order_relaxed);
+				if (!drained((epoch + 1) & 1))
+				{
+					break;
+				}
+				_Epoch.store(epoch + 1, std::memory_order_release);
+			}
+
+			// 교체된 뒤 두 phase 가 모두 한 번씩 비었으면 그 snapshot 을 보는 reader 는 없음
+			std::size_t const epoch = _Epoch.load(std::memory_order_relaxed);
+			std::erase_if(_Retired,
+				[epoch](RetiredSnapshot const& retiredSnapshot)
+				{
+					if (retiredSnapshot._Epoch + 2 <= epoch)
+					{
+						delete retiredSnapshot._Snapshot;
+						return true;
+					}
+					return false;
+				}
+			);
+			_RetiredPending.store(!_Retired.empty(), std::memory_order_relaxed);
+		}
+	};
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::key
+{
+	// 여러 thread 에서 동시에 등록/해제/통지 가능한 dispatcher
+	// notifyEvent 는 잠금 없이 snapshot 을 읽고, 등록/해제는 통지를 막지 않음
+	// EventType 으로 나눈 shard 마다 snapshot 을 두어 등록 시 복사 비용을 줄임
+	class ConcurrentEventDispatcher
+	{
+	public:
+		static constexpr std::size_t ShardCount = 16;
+
+	private:
+		struct EventHandlerEntry
+		{
+			Key _Key;
+			EventHandler _EventHandler;
+		};
+		using EventHandlerList = std::vector<EventHandlerEntry>;
+		using EventHandlerTable = FlatHashMap<EventType, std::shared_ptr<EventHandlerList const>>;
+
+		struct alignas(64) Shard
+		{
+			SnapshotCell<EventHandlerTable> _EventHandlerTable;
+		};
+
+	private:
+		std::array<Shard, ShardCount> _Shards;
+
+	public:
+		void registerEventHandler(EventType const eventType, Key const key, EventHandler const& eventHandler);
+		template<typename TEvent, typename Handler>
+		void registerEventHandler(Key const key, Handler&& handler);
+		void unregisterEventHandler(EventType const eventType, Key const key);
+		void unregisterEventHandler(Key const key);
+		// 해제 전에 시작된 notifyEvent 가 모두 끝날 때까지 기다림
+		// 해제한 handler 가 참조하던 상태는 이 뒤에 정리해야 함, handler 안에서 호출하면 끝나지 않음
+		void synchronize();
+
+	protected:
+		void dispatchEvent(EventType const eventType, Event& event);
+
+	public:
+		void notifyEvent(EventType const eventType, Event& event);
+		void notifyEvent(EventType const eventType, std::shared_ptr<EventData> eventData);
+		template<typename TEvent> void notifyEvent(typename TEvent::PayloadType const& eventPayload);
+
+	private:
+		Shard& shardOf(EventType const eventType);
+	};
+
+	template<typename TEvent, typename Handler>
+	void ConcurrentEventDispatcher::registerEventHandler(Key const key, Handler&& handler)
+	{
+		registerEventHandler(TEvent::eventType, key, makeEventHandler<TEvent>(std::forward<Handler>(handler)));
+	}
+
+	template<typename TEvent>
+	void ConcurrentEventDispatcher::notifyEvent(typename TEvent::PayloadType const& eventPayload)
+	{
+		Event event{ TEvent::eventType, &eventPayload };
+		dispatchEvent(TEvent::eventType, event);
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	// 여러 thread 에서 동시에 등록/해제/통지 가능한 dispatcher
+	// EventTarget 주소로 나눈 shard 마다 snapshot 을 두어 등록 시 복사 비용과 reader 경합을 줄임
+	class ConcurrentEventDispatcher
+	{
+	public:
+		using Token = std::uint64_t;
+		static constexpr std::size_t ShardCount = 16;
+
+	private:
+		struct EventHandlerEntry
+		{
+			Token _Token;
+			EventHandler _EventHandler;
+		};
+		using EventHandlerList = std::vector<EventHandlerEntry>;
+
+		struct EventHandlerTableEntry
+		{
+			WeakEventTarget _EventTarget;
+			std::shared_ptr<EventHandlerList const> _EventHandlers;
+		};
+		using EventHandlerTable = FlatHashMap<EventKey, EventHandlerTableEntry, EventKeyHash>;
+
+		struct alignas(64) Shard
+		{
+			SnapshotCell<EventHandlerTable> _EventHandlerTable;
+			// update() 안에서만 접근, 항목 수가 지난 sweep 의 두 배가 되면 만료된 항목을 정리
+			std::size_t _SweepThreshold{ 64 };
+		};
+
+	private:
+		std::array<Shard, ShardCount> _Shards;
+		std::atomic<Token> _CurrentToken{ 0 };
+
+	public:
+		Token registerEventHandler(EventType const eventType, EventTarget const& eventTarget, EventHandler const& eventHandler);
+		template<typename TEvent, typename Handler>
+		Token registerEventHandler(EventTarget const& eventTarget, Handler&& handler);
+		void unregisterEventHandler(EventType const eventType, EventTarget const& eventTarget, Token const token);
+		void unregisterEventHandler(EventTarget const& eventTarget);
+		// 해제 전에 시작된 notifyEvent 가 모두 끝날 때까지 기다림
+		// 해제한 handler 가 참조하던 상태는 이 뒤에 정리해야 함, handler 안에서 호출하면 끝나지 않음
+		void synchronize();
+		// 이미 소멸된 EventTarget 의 항목을 지우고 지운 수를 반환, registerEventHandler 도 shard 가 커질 때마다 호출
+		std::size_t sweep();
+
+	protected:
+		void dispatchEvent(EventType const eventType, void const* eventTarget, Event& event);
+
+	public:
+		void notifyEvent(EventType const eventType, EventTarget const& eventTarget, Event& event);
+		void notifyEvent(EventType const eventType, EventTarget const& eventTarget, std::shared_ptr<EventData> eventData);
+		template<typename TEvent> void notifyEvent(EventTarget const& eventTarget, typename TEvent::PayloadType const& eventPayload);
+
+	private:
+		Shard& shardOf(void const* eventTarget);
+		static std::size_t eraseExpiredEntries(EventHandlerTable& eventHandlerTable);
+	};
+
+	template<typename TEvent, typename Handler>
+	ConcurrentEventDispatcher::Token ConcurrentEventDispatcher::registerEventHandler(EventTarget const& eventTarget, Handler&& handler)
+	{
+		return registerEventHandler(TEvent::eventType, eventTarget, makeEventHandler<TEvent>(std::forward<Handler>(handler)));
+	}
+
+	template<typename TEvent>
+	void ConcurrentEventDispatcher::notifyEvent(EventTarget const& eventTarget, typename TEvent::PayloadType const& eventPayload)
+	{
+		Event event{ TEvent::eventType, &eventPayload };
+		dispatchEvent(TEvent::eventType, eventTarget.get(), event);
+	}
+}
+
+
+
+
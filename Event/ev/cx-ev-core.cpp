@@ -12,10 +12,22 @@
 //===========================================================================
 namespace cx::ev
 {
+	Event::Event(EventType const eventType) :
+		_EventType(eventType),
+		_Handled(false)
+	{
+	}
 	Event::Event(EventType const eventType, std::shared_ptr<EventData>& eventData) :
-		_Handled(false),
 		_EventType(eventType),
-		_EventData(eventData)
+		_EventData(eventData),
+		_Handled(false)
+	{
+	}
+	Event::Event(EventType const eventType, void const* eventPayload, PayloadTypeId const eventPayloadType) :
+		_EventType(eventType),
+		_EventPayload(eventPayload),
+		_EventPayloadType(eventPayloadType),
+		_Handled(false)
 	{
 	}
 	EventType Event::eventType() const
@@ -26,6 +38,14 @@ namespace cx::ev
 	{
 		return _EventData;
 	}
+	void const* Event::eventPayload() const
+	{
+		return _EventPayload;
+	}
+	PayloadTypeId Event::eventPayloadType() const
+	{
+		return _EventPayloadType;
+	}
 	bool Event::handled() const
 	{
 		return _Handled;
@@ -34,6 +54,30 @@ namespace cx::ev
 	{
 		_Handled = handled;
 	}
+	EventPhase Event::eventPhase() const
+	{
+		return _EventPhase;
+	}
+	void Event::eventPhase(EventPhase const eventPhase)
+	{
+		_EventPhase = eventPhase;
+	}
+	void const* Event::eventTarget() const
+	{
+		return _EventTarget;
+	}
+	void Event::eventTarget(void const* eventTarget)
+	{
+		_EventTarget = eventTarget;
+	}
+	void const* Event::currentEventTarget() const
+	{
+		return _CurrentEventTarget;
+	}
+	void Event::currentEventTarget(void const* currentEventTarget)
+	{
+		_CurrentEventTarget = currentEventTarget;
+	}
 }
 
 
@@ -5,6 +5,131 @@
 namespace cx::ev
 {
 	using EventType = std::int32_t;
+
+	// [begin, end) 범위의 EventType, 범위 구독에 사용
+	// EventType 의 모든 값을 담을 수 있도록 64 비트로 보관
+	struct EventTypeRange
+	{
+		std::int64_t begin;
+		std::int64_t end;
+
+		static constexpr EventTypeRange all()
+		{
+			return EventTypeRange{ std::numeric_limits<EventType>::min(), std::int64_t{ std::numeric_limits<EventType>::max() } + 1 };
+		}
+		static constexpr EventTypeRange only(EventType const eventType)
+		{
+			return EventTypeRange{ eventType, std::int64_t{ eventType } + 1 };
+		}
+
+		constexpr bool contains(EventType const eventType) const
+		{
+			return begin <= eventType && eventType < end;
+		}
+	};
+
+	inline bool operator==(EventTypeRange const& lhs, EventTypeRange const& rhs)
+	{
+		return (lhs.begin == rhs.begin && lhs.end == rhs.end);
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// 범위 구독 handler 를 EventType 구간별로 미리 모은 EventListener 표 (key, target EventDispatcher 공용)
+	// - 범위 구독의 경계 (begin, end) 로 EventType 축을 나누면 한 구간 안에서는 맞는 handler 가 같음
+	// - 구독이 바뀔 때 rebuild() 로 구간마다 EventListener 를 만들고, dispatch 는 구간을 이진 탐색으로 찾기만 함
+	// - 구간 수는 범위 구독 수의 두 배 이하, dispatch 된 EventType 을 따로 기록하지 않음
+	template<typename TEventListener>
+	class PatternEventListenerTable
+	{
+	private:
+		struct Segment
+		{
+			// 다음 Segment 의 _Begin 까지, 맞는 handler 가 없으면 _EventListener 는 nullptr
+			std::int64_t _Begin;
+			std::shared_ptr<TEventListener> _EventListener;
+		};
+
+	private:
+		std::vector<Segment> _Segments;
+
+	public:
+		// attach(TEventListener&, patternEventHandler) 로 handler 를 붙이고, 이전 EventListener 는 retire(std::shared_ptr<TEventListener>) 로 넘김
+		// patternEventHandler 는 _EventTypes (EventTypeRange) 를 가져야 함
+		template<typename TPatternEventHandler, typename Attach, typename Retire>
+		void rebuild(std::vector<TPatternEventHandler> const& patternEventHandlers, Attach&& attach, Retire&& retire)
+		{
+			clear(retire);
+
+			std::vector<std::int64_t> bounds;
+			bounds.reserve(patternEventHandlers.size() * 2);
+			for (auto const& patternEventHandler : patternEventHandlers)
+			{
+				bounds.push_back(patternEventHandler._EventTypes.begin);
+				bounds.push_back(patternEventHandler._EventTypes.end);
+			}
+			std::sort(bounds.begin(), bounds.end());
+			bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+			if (bounds.empty())
+			{
+				return;
+			}
+
+			_Segments.reserve(bounds.size());
+			for (std::size_t index = 0; index + 1 < bounds.size(); index++)
+			{
+				std::shared_ptr<TEventListener> eventListener;
+				for (auto const& patternEventHandler : patternEventHandlers)
+				{
+					if (patternEventHandler._EventTypes.begin <= bounds[index] && bounds[index] < patternEventHandler._EventTypes.end)
+					{
+						if (!eventListener)
+						{
+							eventListener = std::allocate_shared<TEventListener>(PoolAllocator<TEventListener>{});
+						}
+						attach(*eventListener, patternEventHandler);
+					}
+				}
+				_Segments.push_back({ bounds[index], std::move(eventListener) });
+			}
+			_Segments.push_back({ bounds.back(), nullptr });
+		}
+		template<typename Retire>
+		void clear(Retire&& retire)
+		{
+			for (auto& segment : _Segments)
+			{
+				if (segment._EventListener)
+				{
+					retire(std::move(segment._EventListener));
+				}
+			}
+			_Segments.clear();
+		}
+
+	public:
+		TEventListener* find(EventType const eventType) const
+		{
+			auto it = std::upper_bound(_Segments.begin(), _Segments.end(), std::int64_t{ eventType },
+				[](std::int64_t const value, Segment const& segment)
+				{
+					return value < segment._Begin;
+				}
+			);
+			if (it == _Segments.begin())
+			{
+				return nullptr;
+			}
+			return std::prev(it)->_EventListener.get();
+		}
+	};
 }
 
 
@@ -20,6 +145,14 @@ namespace cx::ev
 	public:
 		virtual ~EventData() = default;
 	};
+
+	// EventData 와 control block 을 thread 별 MemoryPool 에서 한 번에 할당
+	// 예) eventDispatcher.notifyEvent(eventType, makeEventData<ValueChangedData>(...));
+	template<typename T, typename... Args>
+	std::shared_ptr<T> makeEventData(Args&&... args)
+	{
+		return std::allocate_shared<T>(PoolAllocator<T>{}, std::forward<Args>(args)...);
+	}
 }
 
 
@@ -30,15 +163,55 @@ namespace cx::ev
 //===========================================================================
 namespace cx::ev
 {
+	// payload 타입마다 하나씩 있는 주소, Event 가 담은 payload 를 다른 타입으로 꺼내지 않도록 확인하는 데 사용
+	using PayloadTypeId = void const*;
+
+	template<typename T>
+	inline constexpr char PayloadTypeTag{};
+
+	template<typename T>
+	constexpr PayloadTypeId payloadTypeIdOf()
+	{
+		return &PayloadTypeTag<std::remove_cv_t<T>>;
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// target::EventPropagator 가 전달 중인 단계, 그 밖의 dispatcher 에서는 None
+	enum class EventPhase
+	{
+		None,
+		Capture,
+		Target,
+		Bubble
+	};
+
 	class Event
 	{
 	private:
 		EventType _EventType;
 		std::shared_ptr<EventData> _EventData;
+		void const* _EventPayload{ nullptr };
+		PayloadTypeId _EventPayloadType{ nullptr };
 		bool _Handled{ false };
+		EventPhase _EventPhase{ EventPhase::None };
+		void const* _EventTarget{ nullptr };
+		void const* _CurrentEventTarget{ nullptr };
 
 	public:
+		explicit Event(EventType const eventType);
 		explicit Event(EventType const eventType, std::shared_ptr<EventData>& eventData);
+		// payload 는 참조만 함, eventPayloadAs<T> 는 같은 T 로만 꺼낼 수 있음
+		template<typename T> explicit Event(EventType const eventType, T const* eventPayload);
+		// 타입을 지운 채 보관한 payload 용, eventPayloadType 은 payloadTypeIdOf<T>() 로 얻은 값
+		explicit Event(EventType const eventType, void const* eventPayload, PayloadTypeId const eventPayloadType);
 
 	public:
 		virtual ~Event() = default;
@@ -47,10 +220,24 @@ namespace cx::ev
 		EventType eventType() const;
 		std::shared_ptr<EventData> eventData() const;
 		template<typename T> std::shared_ptr<T> eventDataAs() const;
+		void const* eventPayload() const;
+		PayloadTypeId eventPayloadType() const;
+		template<typename T> bool eventPayloadIs() const;
+		// debug 빌드에서는 담은 payload 타입과 T 가 다르면 assert
+		template<typename T> T const& eventPayloadAs() const;
 
 	public:
 		bool handled() const;
 		void handled(bool const handled);
+
+	public:
+		// 전파 중: eventTarget 은 처음 통지한 대상, currentEventTarget 은 지금 handler 가 붙어 있는 대상
+		EventPhase eventPhase() const;
+		void eventPhase(EventPhase const eventPhase);
+		void const* eventTarget() const;
+		void eventTarget(void const* eventTarget);
+		void const* currentEventTarget() const;
+		void currentEventTarget(void const* currentEventTarget);
 	};
 
 	template<typename T>
@@ -58,6 +245,25 @@ namespace cx::ev
 	{
 		return std::dynamic_pointer_cast<T>(_EventData);
 	}
+
+	template<typename T>
+	Event::Event(EventType const eventType, T const* eventPayload) :
+		Event(eventType, static_cast<void const*>(eventPayload), payloadTypeIdOf<T>())
+	{
+	}
+
+	template<typename T>
+	bool Event::eventPayloadIs() const
+	{
+		return _EventPayloadType == payloadTypeIdOf<T>();
+	}
+
+	template<typename T>
+	T const& Event::eventPayloadAs() const
+	{
+		assert(eventPayloadIs<T>() && "Event payload type mismatch");
+		return *static_cast<T const*>(_EventPayload);
+	}
 }
 
 
@@ -68,7 +274,75 @@ namespace cx::ev
 //===========================================================================
 namespace cx::ev
 {
-	using EventHandler = std::function<void(Event&)>;
+	using EventHandler = Delegate<void(Event&)>;
+
+	// 값이 클수록 먼저 호출, 같은 priority 끼리는 붙인 순서대로 호출
+	using EventHandlerPriority = std::int32_t;
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// EventType 과 payload 타입을 컴파일 시간에 묶음
+	// 예) using ValueChanged = TypedEvent<1, ValueChangedData>;
+	template<EventType Type, typename Payload>
+	struct TypedEvent
+	{
+		static constexpr EventType eventType = Type;
+		using PayloadType = Payload;
+	};
+
+	// handler(PayloadType const&) 또는 handler(Event&, PayloadType const&) 를 EventHandler 로 감쌈
+	// payload 는 참조로 전달되며 할당이 없음, 형 변환 검사는 payload 타입 주소 비교 한 번
+	template<typename TEvent, typename Handler>
+	EventHandler makeEventHandler(Handler&& handler)
+	{
+		using Payload = typename TEvent::PayloadType;
+
+		return EventHandler(
+			[handler = std::forward<Handler>(handler)](Event& event) mutable
+			{
+				if (!event.eventPayload())
+				{
+					return;
+				}
+				// 같은 EventType 에 다른 payload 타입이 통지됨: debug 에서는 멈추고 release 에서는 무시
+				assert(event.eventPayloadIs<Payload>() && "Event payload type does not match TypedEvent");
+				if (!event.eventPayloadIs<Payload>())
+				{
+					return;
+				}
+				if constexpr (std::is_invocable_v<Handler&, Event&, Payload const&>)
+				{
+					handler(event, event.eventPayloadAs<Payload>());
+				}
+				else
+				{
+					handler(event.eventPayloadAs<Payload>());
+				}
+			}
+		);
+	}
+
+	// 객체를 weak_ptr 로 붙잡는 멤버함수 handler, 객체가 소멸되면 호출하지 않음
+	template<auto Method, typename Object>
+	EventHandler makeWeakEventHandler(std::shared_ptr<Object> const& object)
+	{
+		return EventHandler(
+			[object = std::weak_ptr<Object>(object)](Event& event)
+			{
+				if (auto locked = object.lock())
+				{
+					((*locked).*Method)(event);
+				}
+			}
+		);
+	}
 }
 
 
@@ -0,0 +1,213 @@
+﻿/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+#include "pch.hpp"
+
+#include "cx-ev.hpp"
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::key
+{
+	DeferredEventQueue::Frame::Frame(std::size_t const payloadCapacity, std::size_t const eventCapacity) :
+		_FrameArena(payloadCapacity)
+	{
+		_DeferredEvents.reserve(eventCapacity);
+		_Order.reserve(eventCapacity);
+		_Events.reserve(eventCapacity);
+	}
+	bool DeferredEventQueue::Frame::empty() const
+	{
+		return _DeferredEvents.empty();
+	}
+	void DeferredEventQueue::Frame::clear()
+	{
+		_Events.clear();
+		_Order.clear();
+		_DeferredEvents.clear();
+		_FrameArena.reset();
+	}
+	DeferredEventQueue::DeferredEventQueue(
+		EventDispatcher& eventDispatcher,
+		DeferredEventOrder const deferredEventOrder,
+		std::size_t const payloadCapacity,
+		std::size_t const eventCapacity
+	) :
+		_EventDispatcher(eventDispatcher),
+		_DeferredEventOrder(deferredEventOrder),
+		_Frames(payloadCapacity, eventCapacity)
+	{
+	}
+	void DeferredEventQueue::postEvent(EventType const eventType, std::shared_ptr<EventData> eventData)
+	{
+		_Frames.posting()._DeferredEvents.push_back({ eventType, std::move(eventData), nullptr, nullptr });
+	}
+	std::size_t DeferredEventQueue::processQueue()
+	{
+		if (!_Frames.ready())
+		{
+			return 0;
+		}
+
+		// handler 안에서 post 된 이벤트는 다른 버퍼에 쌓임
+		DoubleBuffer<Frame>::ProcessScope processScope{ _Frames };
+
+		auto& frame = processScope.buffer();
+		auto& deferredEvents = frame._DeferredEvents;
+		if (_DeferredEventOrder == DeferredEventOrder::GroupedByType)
+		{
+			// (EventType, post 순서) 로 정렬하므로 같은 EventType 안의 순서가 유지되고 추가 할당이 없음
+			for (std::size_t i = 0; i < deferredEvents.size(); i++)
+			{
+				frame._Order.emplace_back(deferredEvents[i]._EventType, static_cast<std::uint32_t>(i));
+			}
+			std::sort(frame._Order.begin(), frame._Order.end());
+			for (auto const& order : frame._Order)
+			{
+				auto& deferredEvent = deferredEvents[order.second];
+				if (deferredEvent._EventPayload)
+				{
+					frame._Events.emplace_back(deferredEvent._EventType, deferredEvent._EventPayload, deferredEvent._EventPayloadType);
+				}
+				else
+				{
+					frame._Events.emplace_back(deferredEvent._EventType, deferredEvent._EventData);
+				}
+			}
+		}
+		else
+		{
+			for (auto& deferredEvent : deferredEvents)
+			{
+				if (deferredEvent._EventPayload)
+				{
+					frame._Events.emplace_back(deferredEvent._EventType, deferredEvent._EventPayload, deferredEvent._EventPayloadType);
+				}
+				else
+				{
+					frame._Events.emplace_back(deferredEvent._EventType, deferredEvent._EventData);
+				}
+			}
+		}
+		_EventDispatcher.notifyEvents(frame._Events);
+
+		return frame._Events.size();
+	}
+	std::size_t DeferredEventQueue::pendingCount() const
+	{
+		return _Frames.posting()._DeferredEvents.size();
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	DeferredEventQueue::Frame::Frame(std::size_t const payloadCapacity, std::size_t const eventCapacity) :
+		_FrameArena(payloadCapacity)
+	{
+		_DeferredEvents.reserve(eventCapacity);
+		_Order.reserve(eventCapacity);
+		_EventTargets.reserve(eventCapacity);
+		_Events.reserve(eventCapacity);
+	}
+	bool DeferredEventQueue::Frame::empty() const
+	{
+		return _DeferredEvents.empty();
+	}
+	void DeferredEventQueue::Frame::clear()
+	{
+		_Events.clear();
+		_EventTargets.clear();
+		_Order.clear();
+		_DeferredEvents.clear();
+		_FrameArena.reset();
+	}
+	DeferredEventQueue::DeferredEventQueue(
+		EventDispatcher& eventDispatcher,
+		DeferredEventOrder const deferredEventOrder,
+		std::size_t const payloadCapacity,
+		std::size_t const eventCapacity
+	) :
+		_EventDispatcher(eventDispatcher),
+		_DeferredEventOrder(deferredEventOrder),
+		_Frames(payloadCapacity, eventCapacity)
+	{
+	}
+	void DeferredEventQueue::postEvent(EventType const eventType, EventTarget const& eventTarget, std::shared_ptr<EventData> eventData)
+	{
+		_Frames.posting()._DeferredEvents.push_back({ eventType, eventTarget, std::move(eventData), nullptr, nullptr });
+	}
+	std::size_t DeferredEventQueue::processQueue()
+	{
+		if (!_Frames.ready())
+		{
+			return 0;
+		}
+
+		// handler 안에서 post 된 이벤트는 다른 버퍼에 쌓임
+		DoubleBuffer<Frame>::ProcessScope processScope{ _Frames };
+
+		auto& frame = processScope.buffer();
+		auto& deferredEvents = frame._DeferredEvents;
+
+		// 통지하는 동안만 EventTarget 을 살려두고, 이미 사라진 EventTarget 의 이벤트는 버림
+		auto append = [&frame](DeferredEvent& deferredEvent)
+		{
+			auto eventTarget = deferredEvent._EventTarget.lock();
+			if (!eventTarget)
+			{
+				return;
+			}
+
+			frame._EventTargets.push_back(std::move(eventTarget));
+			if (deferredEvent._EventPayload)
+			{
+				frame._Events.emplace_back(deferredEvent._EventType, deferredEvent._EventPayload, deferredEvent._EventPayloadType);
+			}
+			else
+			{
+				frame._Events.emplace_back(deferredEvent._EventType, deferredEvent._EventData);
+			}
+		};
+
+		if (_DeferredEventOrder == DeferredEventOrder::GroupedByType)
+		{
+			// (EventType, post 순서) 로 정렬하므로 같은 EventType 안의 순서가 유지되고 추가 할당이 없음
+			for (std::size_t i = 0; i < deferredEvents.size(); i++)
+			{
+				frame._Order.emplace_back(deferredEvents[i]._EventType, static_cast<std::uint32_t>(i));
+			}
+			std::sort(frame._Order.begin(), frame._Order.end());
+			for (auto const& order : frame._Order)
+			{
+				append(deferredEvents[order.second]);
+			}
+		}
+		else
+		{
+			for (auto& deferredEvent : deferredEvents)
+			{
+				append(deferredEvent);
+			}
+		}
+		_EventDispatcher.notifyEvents(frame._EventTargets, frame._Events);
+
+		return frame._Events.size();
+	}
+	std::size_t DeferredEventQueue::pendingCount() const
+	{
+		return _Frames.posting()._DeferredEvents.size();
+	}
+}
+
+
+
+
@@ -0,0 +1,170 @@
+﻿#pragma once
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// processQueue() 가 쌓인 이벤트를 통지하는 순서
+	enum class DeferredEventOrder
+	{
+		Posted,       // post 된 순서 그대로
+		GroupedByType // EventType 별로 모음, 같은 EventType 안에서는 post 된 순서 유지
+	};
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::key
+{
+	// frame 동안 post 된 이벤트를 쌓아 두었다가 processQueue() 에서 한 번에 통지
+	// - payload 는 FrameArena 에 복사 (포인터 증가만으로 할당), 기록 배열은 용량을 재사용하므로 평소에는 할당 없음
+	// - 버퍼 두 벌을 번갈아 사용 (DoubleBuffer): processQueue() 중(handler 안)에 post 된 이벤트는 다음 processQueue() 에서 통지
+	// - 한 thread 에서만 사용
+	class DeferredEventQueue
+	{
+	private:
+		struct DeferredEvent
+		{
+			EventType _EventType;
+			std::shared_ptr<EventData> _EventData;
+			void const* _EventPayload;
+			PayloadTypeId _EventPayloadType;
+		};
+
+		// 통지에 쓰는 배열도 frame 마다 두어 통지가 끝나면 (예외여도) 함께 비움, 크기는 재사용
+		struct Frame
+		{
+			FrameArena _FrameArena;
+			std::vector<DeferredEvent> _DeferredEvents;
+			std::vector<std::pair<EventType, std::uint32_t>> _Order;
+			std::vector<Event> _Events;
+
+			Frame(std::size_t const payloadCapacity, std::size_t const eventCapacity);
+
+			bool empty() const;
+			void clear();
+		};
+
+	private:
+		EventDispatcher& _EventDispatcher;
+		DeferredEventOrder _DeferredEventOrder;
+		DoubleBuffer<Frame> _Frames;
+
+	public:
+		explicit DeferredEventQueue(
+			EventDispatcher& eventDispatcher,
+			DeferredEventOrder const deferredEventOrder = DeferredEventOrder::GroupedByType,
+			std::size_t const payloadCapacity = 64 * 1024,
+			std::size_t const eventCapacity = 1024
+		);
+
+	public:
+		DeferredEventQueue(DeferredEventQueue const&) = delete;
+		DeferredEventQueue& operator=(DeferredEventQueue const&) = delete;
+
+	public:
+		void postEvent(EventType const eventType, std::shared_ptr<EventData> eventData);
+		// payload 는 processQueue() 가 끝날 때까지 FrameArena 에 보관
+		template<typename TEvent> void postEvent(typename TEvent::PayloadType const& eventPayload);
+		// frame 마다 정해진 단계에서 한 번 호출, 통지한 이벤트 수 반환. processQueue() 안에서 다시 호출하면 아무것도 하지 않음
+		std::size_t processQueue();
+
+	public:
+		std::size_t pendingCount() const;
+	};
+
+	template<typename TEvent>
+	void DeferredEventQueue::postEvent(typename TEvent::PayloadType const& eventPayload)
+	{
+		Frame& frame = _Frames.posting();
+		auto& payload = frame._FrameArena.create<typename TEvent::PayloadType>(eventPayload);
+		frame._DeferredEvents.push_back({ TEvent::eventType, nullptr, &payload, payloadTypeIdOf<typename TEvent::PayloadType>() });
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	// frame 동안 post 된 (EventType, EventTarget, payload) 를 쌓아 두었다가 processQueue() 에서 한 번에 통지
+	// - payload 는 FrameArena 에 복사 (포인터 증가만으로 할당), 기록 배열은 용량을 재사용하므로 평소에는 할당 없음
+	// - 버퍼 두 벌을 번갈아 사용 (DoubleBuffer): processQueue() 중(handler 안)에 post 된 이벤트는 다음 processQueue() 에서 통지
+	// - 같은 (EventType, EventTarget) 이 이어지는 구간마다 EventListener 를 한 번만 찾음
+	//   GroupedByType 은 (EventType, post 순서) 로만 정렬하므로 같은 EventType 안에서 EventTarget 이 섞여 있으면 구간이 나뉨
+	// - EventTarget 은 약한 참조로 보관해 대기 중인 이벤트가 객체 수명을 늘리지 않음, processQueue() 전에 사라진 EventTarget 의 이벤트는 버림
+	// - 한 thread 에서만 사용
+	class DeferredEventQueue
+	{
+	private:
+		struct DeferredEvent
+		{
+			EventType _EventType;
+			WeakEventTarget _EventTarget;
+			std::shared_ptr<EventData> _EventData;
+			void const* _EventPayload;
+			PayloadTypeId _EventPayloadType;
+		};
+
+		// 통지에 쓰는 배열도 frame 마다 두어 통지가 끝나면 (예외여도) 함께 비움, 크기는 재사용
+		struct Frame
+		{
+			FrameArena _FrameArena;
+			std::vector<DeferredEvent> _DeferredEvents;
+			std::vector<std::pair<EventType, std::uint32_t>> _Order;
+			std::vector<EventTarget> _EventTargets;
+			std::vector<Event> _Events;
+
+			Frame(std::size_t const payloadCapacity, std::size_t const eventCapacity);
+
+			bool empty() const;
+			void clear();
+		};
+
+	private:
+		EventDispatcher& _EventDispatcher;
+		DeferredEventOrder _DeferredEventOrder;
+		DoubleBuffer<Frame> _Frames;
+
+	public:
+		explicit DeferredEventQueue(
+			EventDispatcher& eventDispatcher,
+			DeferredEventOrder const deferredEventOrder = DeferredEventOrder::GroupedByType,
+			std::size_t const payloadCapacity = 64 * 1024,
+			std::size_t const eventCapacity = 1024
+		);
+
+	public:
+		DeferredEventQueue(DeferredEventQueue const&) = delete;
+		DeferredEventQueue& operator=(DeferredEventQueue const&) = delete;
+
+	public:
+		void postEvent(EventType const eventType, EventTarget const& eventTarget, std::shared_ptr<EventData> eventData);
+		// payload 는 processQueue() 가 끝날 때까지 FrameArena 에 보관
+		template<typename TEvent> void postEvent(EventTarget const& eventTarget, typename TEvent::PayloadType const& eventPayload);
+		// frame 마다 정해진 단계에서 한 번 호출, 통지한 이벤트 수 (버린 이벤트 제외) 반환. processQueue() 안에서 다시 호출하면 아무것도 하지 않음
+		std::size_t processQueue();
+
+	public:
+		std::size_t pendingCount() const;
+	};
+
+	template<typename TEvent>
+	void DeferredEventQueue::postEvent(EventTarget const& eventTarget, typename TEvent::PayloadType const& eventPayload)
+	{
+		Frame& frame = _Frames.posting();
+		auto& payload = frame._FrameArena.create<typename TEvent::PayloadType>(eventPayload);
+		frame._DeferredEvents.push_back({ TEvent::eventType, eventTarget, nullptr, &payload, payloadTypeIdOf<typename TEvent::PayloadType>() });
+	}
+}
+
+
+
+
@@ -0,0 +1,259 @@
+﻿#pragma once
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	template<typename Signature>
+	class Delegate;
+
+	// std::function 대체: InlineSize 이하의 호출 객체는 힙 할당 없이 내부 버퍼에 저장
+	// 멤버함수+객체 (bind<&T::f>(object)), 작은 람다, std::bind 결과는 내부 버퍼에 들어감
+	template<typename R, typename... Args>
+	class Delegate<R(Args...)>
+	{
+	public:
+		static constexpr std::size_t InlineSize = sizeof(void*) * 6;
+
+	private:
+		enum class Operation
+		{
+			Copy,
+			Move,
+			Destroy
+		};
+
+		using Function = R(*)(Args...);
+		using Invoker = R(*)(void*, Args...);
+		using Manager = void(*)(Operation, void*, void*);
+
+	private:
+		alignas(std::max_align_t) std::byte _Storage[InlineSize];
+		Function _Function{ nullptr };
+		Invoker _Invoker{ nullptr };
+		Manager _Manager{ nullptr };
+		// _Manager 없이 내부 버퍼에 둔 호출 객체의 크기, 복사/이동은 이 만큼만 memcpy (정렬 여백에 들어가므로 크기 증가 없음)
+		std::size_t _StorageSize{ 0 };
+
+	public:
+		template<typename F>
+		static constexpr bool isInline =
+			sizeof(F) <= InlineSize &&
+			alignof(F) <= alignof(std::max_align_t) &&
+			std::is_nothrow_move_constructible_v<F>;
+
+	public:
+		Delegate() = default;
+		Delegate(std::nullptr_t)
+		{
+		}
+		Delegate(Function function) :
+			_Function(function)
+		{
+		}
+		template<typename F>
+			requires (!std::is_same_v<std::remove_cvref_t<F>, Delegate> && std::is_invocable_r_v<R, std::remove_cvref_t<F>&, Args...>)
+		Delegate(F&& f)
+		{
+			if constexpr (std::is_convertible_v<F, Function>)
+			{
+				// 캡처 없는 람다는 함수 포인터 경로로 저장
+				_Function = f;
+			}
+			else
+			{
+				assign(std::forward<F>(f));
+			}
+		}
+		Delegate(Delegate const& other)
+		{
+			copyFrom(other);
+		}
+		Delegate(Delegate&& other) noexcept
+		{
+			moveFrom(other);
+		}
+
+	public:
+		~Delegate()
+		{
+			reset();
+		}
+
+	public:
+		Delegate& operator=(Delegate const& other)
+		{
+			if (this != &other)
+			{
+				reset();
+				copyFrom(other);
+			}
+			return *this;
+		}
+		Delegate& operator=(Delegate&& other) noexcept
+		{
+			if (this != &other)
+			{
+				reset();
+				moveFrom(other);
+			}
+			return *this;
+		}
+		Delegate& operator=(std::nullptr_t)
+		{
+			reset();
+			return *this;
+		}
+
+	public:
+		// 멤버함수를 컴파일 시간에 고정: 객체(원시 포인터 또는 shared_ptr)만 내부 버퍼에 저장
+		template<auto Method, typename Object>
+		static Delegate bind(Object* object)
+		{
+			return Delegate(
+				[object](Args... args) -> R
+				{
+					return (object->*Method)(std::forward<Args>(args)...);
+				}
+			);
+		}
+		template<auto Method, typename Object>
+		static Delegate bind(std::shared_ptr<Object> object)
+		{
+			return Delegate(
+				[object = std::move(object)](Args... args) -> R
+				{
+					return ((*object).*Method)(std::forward<Args>(args)...);
+				}
+			);
+		}
+
+	public:
+		explicit operator bool() const
+		{
+			return _Function || _Invoker;
+		}
+		R operator()(Args... args) const
+		{
+			if (_Function)
+			{
+				return _Function(std::forward<Args>(args)...);
+			}
+			return _Invoker(const_cast<std::byte*>(_Storage), std::forward<Args>(args)...);
+		}
+
+	public:
+		void reset()
+		{
+			if (_Manager)
+			{
+				_Manager(Operation::Destroy, _Storage, nullptr);
+			}
+			_Function = nullptr;
+			_Invoker = nullptr;
+			_Manager = nullptr;
+			_StorageSize = 0;
+		}
+
+	private:
+		template<typename F>
+		void assign(F&& f)
+		{
+			using Callable = std::remove_cvref_t<F>;
+
+			if constexpr (isInline<Callable>)
+			{
+				::new (static_cast<void*>(_Storage)) Callable(std::forward<F>(f));
+				_Invoker = [](void* storage, Args... args) -> R
+				{
+					return (*static_cast<Callable*>(storage))(std::forward<Args>(args)...);
+				};
+				if constexpr (std::is_trivially_copyable_v<Callable>)
+				{
+					_StorageSize = sizeof(Callable);
+				}
+				else
+				{
+					_Manager = [](Operation operation, void* dst, void* src)
+					{
+						switch (operation)
+						{
+						case Operation::Copy:
+							::new (dst) Callable(*static_cast<Callable const*>(src));
+							break;
+						case Operation::Move:
+							::new (dst) Callable(std::move(*static_cast<Callable*>(src)));
+							static_cast<Callable*>(src)->~Callable();
+							break;
+						case Operation::Destroy:
+							static_cast<Callable*>(dst)->~Callable();
+							break;
+						}
+					};
+				}
+			}
+			else
+			{
+				::new (static_cast<void*>(_Storage)) Callable*(new Callable(std::forward<F>(f)));
+				_Invoker = [](void* storage, Args... args) -> R
+				{
+					return (**static_cast<Callable**>(storage))(std::forward<Args>(args)...);
+				};
+				_Manager = [](Operation operation, void* dst, void* src)
+				{
+					switch (operation)
+					{
+					case Operation::Copy:
+						::new (dst) Callable*(new Callable(**static_cast<Callable* const*>(src)));
+						break;
+					case Operation::Move:
+						::new (dst) Callable*(*static_cast<Callable**>(src));
+						break;
+					case Operation::Destroy:
+						delete *static_cast<Callable**>(dst);
+						break;
+					}
+				};
+			}
+		}
+		void copyFrom(Delegate const& other)
+		{
+			if (other._Manager)
+			{
+				other._Manager(Operation::Copy, _Storage, const_cast<std::byte*>(other._Storage));
+			}
+			else if (other._Invoker)
+			{
+				std::memcpy(_Storage, other._Storage, other._StorageSize);
+			}
+			_Function = other._Function;
+			_Invoker = other._Invoker;
+			_Manager = other._Manager;
+			_StorageSize = other._StorageSize;
+		}
+		void moveFrom(Delegate& other)
+		{
+			if (other._Manager)
+			{
+				other._Manager(Operation::Move, _Storage, other._Storage);
+			}
+			else if (other._Invoker)
+			{
+				std::memcpy(_Storage, other._Storage, other._StorageSize);
+			}
+			_Function = other._Function;
+			_Invoker = other._Invoker;
+			_Manager = other._Manager;
+			_StorageSize = other._StorageSize;
+
+			other._Function = nullptr;
+			other._Invoker = nullptr;
+			other._Manager = nullptr;
+			other._StorageSize = 0;
+		}
+	};
+}
+
+
+
+
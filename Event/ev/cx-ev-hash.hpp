@@ -0,0 +1,213 @@
+﻿#pragma once
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// open addressing(linear probing) + backward shift 삭제
+	// Key, Value 는 기본 생성 및 이동 가능해야 함
+	template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	class FlatHashMap
+	{
+	private:
+		struct Slot
+		{
+			Key _Key{};
+			Value _Value{};
+			bool _Used{ false };
+		};
+
+	private:
+		std::vector<Slot> _Slots;
+		std::size_t _Size{ 0 };
+
+	public:
+		FlatHashMap() = default;
+
+	public:
+		std::size_t size() const
+		{
+			return _Size;
+		}
+		bool empty() const
+		{
+			return _Size == 0;
+		}
+		// 값은 소멸시키고 용량은 유지, 매번 같은 크기로 다시 채우는 경우 할당이 없음
+		void clear()
+		{
+			if (_Size == 0)
+			{
+				return;
+			}
+			for (auto& slot : _Slots)
+			{
+				if (slot._Used)
+				{
+					slot = Slot{};
+				}
+			}
+			_Size = 0;
+		}
+
+	public:
+		Value* find(Key const& key)
+		{
+			return const_cast<Value*>(static_cast<FlatHashMap const&>(*this).find(key));
+		}
+		Value const* find(Key const& key) const
+		{
+			if (_Size == 0)
+			{
+				return nullptr;
+			}
+
+			std::size_t const mask = _Slots.size() - 1;
+			for (std::size_t index = slotIndex(key); ; index = (index + 1) & mask)
+			{
+				Slot const& slot = _Slots[index];
+				if (!slot._Used)
+				{
+					return nullptr;
+				}
+				if (KeyEqual{}(slot._Key, key))
+				{
+					return &slot._Value;
+				}
+			}
+		}
+		Value& operator[](Key const& key)
+		{
+			if (Value* value = find(key))
+			{
+				return *value;
+			}
+
+			reserve(_Size + 1);
+
+			std::size_t const mask = _Slots.size() - 1;
+			std::size_t index = slotIndex(key);
+			while (_Slots[index]._Used)
+			{
+				index = (index + 1) & mask;
+			}
+
+			Slot& slot = _Slots[index];
+			slot._Key = key;
+			slot._Used = true;
+			_Size++;
+			return slot._Value;
+		}
+		bool erase(Key const& key)
+		{
+			if (_Size == 0)
+			{
+				return false;
+			}
+
+			std::size_t const mask = _Slots.size() - 1;
+			std::size_t index = slotIndex(key);
+			while (true)
+			{
+				Slot& slot = _Slots[index];
+				if (!slot._Used)
+				{
+					return false;
+				}
+				if (KeyEqual{}(slot._Key, key))
+				{
+					break;
+				}
+				index = (index + 1) & mask;
+			}
+
+			// 빈 자리 뒤로 이어지는 클러스터를 당겨서 tombstone 없이 삭제
+			std::size_t hole = index;
+			for (std::size_t next = (hole + 1) & mask; _Slots[next]._Used; next = (next + 1) & mask)
+			{
+				std::size_t const home = slotIndex(_Slots[next]._Key);
+				if (((next - home) & mask) >= ((next - hole) & mask))
+				{
+					_Slots[hole] = std::move(_Slots[next]);
+					hole = next;
+				}
+			}
+			_Slots[hole] = Slot{};
+			_Size--;
+			return true;
+		}
+
+	public:
+		template<typename Function>
+		void forEach(Function&& function)
+		{
+			for (auto& slot : _Slots)
+			{
+				if (slot._Used)
+				{
+					function(slot._Key, slot._Value);
+				}
+			}
+		}
+		template<typename Function>
+		void forEach(Function&& function) const
+		{
+			for (auto const& slot : _Slots)
+			{
+				if (slot._Used)
+				{
+					function(slot._Key, slot._Value);
+				}
+			}
+		}
+
+	public:
+		void reserve(std::size_t const count)
+		{
+			// 최대 load factor 3/4
+			std::size_t capacity = _Slots.empty() ? 16 : _Slots.size();
+			while (count * 4 > capacity * 3)
+			{
+				capacity *= 2;
+			}
+			if (capacity != _Slots.size())
+			{
+				rehash(capacity);
+			}
+		}
+
+	private:
+		std::size_t slotIndex(Key const& key) const
+		{
+			// 포인터처럼 하위 비트가 비어 있는 키도 고르게 퍼지도록 섞음
+			std::uint64_t hash = static_cast<std::uint64_t>(Hash{}(key));
+			hash ^= hash >> 33;
+			hash *= 0xff51afd7ed558ccdULL;
+			hash ^= hash >> 33;
+			return static_cast<std::size_t>(hash) & (_Slots.size() - 1);
+		}
+		void rehash(std::size_t const capacity)
+		{
+			std::vector<Slot> slots(capacity);
+			std::swap(_Slots, slots);
+
+			std::size_t const mask = _Slots.size() - 1;
+			for (auto& slot : slots)
+			{
+				if (slot._Used)
+				{
+					std::size_t index = slotIndex(slot._Key);
+					while (_Slots[index]._Used)
+					{
+						index = (index + 1) & mask;
+					}
+					_Slots[index] = std::move(slot);
+				}
+			}
+		}
+	};
+}
+
+
+
+
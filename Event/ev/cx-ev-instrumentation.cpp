@@ -0,0 +1,485 @@
+﻿/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+#include "pch.hpp"
+
+#include "cx-ev.hpp"
+
+
+
+
+
+#if defined(CX_EV_INSTRUMENTATION)
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	std::size_t Histogram::bucketIndex(std::uint64_t const value)
+	{
+		if (value < SubBucketCount)
+		{
+			return static_cast<std::size_t>(value);
+		}
+
+		std::size_t const shift = static_cast<std::size_t>(std::bit_width(value)) - 1 - SubBucketBits;
+		std::size_t const subBucket = static_cast<std::size_t>(value >> shift) & (SubBucketCount - 1);
+		return SubBucketCount + shift * SubBucketCount + subBucket;
+	}
+	std::uint64_t Histogram::bucketValue(std::size_t const index)
+	{
+		if (index < SubBucketCount)
+		{
+			return index;
+		}
+
+		std::size_t const shift = (index - SubBucketCount) / SubBucketCount;
+		std::size_t const subBucket = (index - SubBucketCount) % SubBucketCount;
+		return (std::uint64_t{ 1 } << (shift + SubBucketBits)) | (static_cast<std::uint64_t>(subBucket) << shift);
+	}
+	void Histogram::record(std::uint64_t const value, std::uint64_t const count)
+	{
+		merge(bucketIndex(value), count);
+	}
+	void Histogram::merge(std::size_t const index, std::uint64_t const count)
+	{
+		_Counts[index] += count;
+		_TotalCount += count;
+	}
+	std::uint64_t Histogram::count(std::size_t const index) const
+	{
+		return _Counts[index];
+	}
+	std::uint64_t Histogram::totalCount() const
+	{
+		return _TotalCount;
+	}
+	std::uint64_t Histogram::percentile(double const quantile) const
+	{
+		if (_TotalCount == 0)
+		{
+			return 0;
+		}
+
+		auto const rank = static_cast<std::uint64_t>(std::clamp(quantile, 0.0, 1.0) * static_cast<double>(_TotalCount));
+		std::uint64_t const target = std::max<std::uint64_t>(1, rank);
+
+		std::uint64_t cumulative = 0;
+		for (std::size_t index = 0; index < BucketCount; index++)
+		{
+			cumulative += _Counts[index];
+			if (cumulative >= target)
+			{
+				return bucketValue(index);
+			}
+		}
+		return bucketValue(BucketCount - 1);
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	namespace
+	{
+		// 기록은 한 thread 에서만 하지만 reset() 이 다른 thread 에서 0 으로 되돌리므로 fetch_add 로 더함
+		struct AtomicHistogram
+		{
+			std::array<std::atomic<std::uint64_t>, Histogram::BucketCount> _Counts{};
+
+			void record(std::uint64_t const value)
+			{
+				_Counts[Histogram::bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+			}
+			void mergeTo(Histogram& histogram) const
+			{
+				for (std::size_t index = 0; index < Histogram::BucketCount; index++)
+				{
+					std::uint64_t const count = _Counts[index].load(std::memory_order_relaxed);
+					if (count)
+					{
+						histogram.merge(index, count);
+					}
+				}
+			}
+			void reset()
+			{
+				for (auto& count : _Counts)
+				{
+					count.store(0, std::memory_order_relaxed);
+				}
+			}
+		};
+
+		// FlatHashMap 이 표를 늘릴 때 값을 옮길 수 있도록 복사 가능
+		// 복사는 표 구조를 바꾸는 기록 thread 가 잠금 안에서만 하므로 값을 읽어 옮기면 충분
+		struct AtomicDispatchCounter
+		{
+			std::atomic<std::uint64_t> _DispatchCount{ 0 };
+			std::atomic<std::uint64_t> _HandlerCount{ 0 };
+			std::atomic<std::uint64_t> _Nanoseconds{ 0 };
+
+			AtomicDispatchCounter() = default;
+			AtomicDispatchCounter(AtomicDispatchCounter const& other)
+			{
+				*this = other;
+			}
+			AtomicDispatchCounter& operator=(AtomicDispatchCounter const& other)
+			{
+				_DispatchCount.store(other._DispatchCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				_HandlerCount.store(other._HandlerCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				_Nanoseconds.store(other._Nanoseconds.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				return *this;
+			}
+
+			void add(DispatchCounter const& dispatchCounter)
+			{
+				_DispatchCount.fetch_add(dispatchCounter.dispatchCount, std::memory_order_relaxed);
+				_HandlerCount.fetch_add(dispatchCounter.handlerCount, std::memory_order_relaxed);
+				_Nanoseconds.fetch_add(dispatchCounter.nanoseconds, std::memory_order_relaxed);
+			}
+			DispatchCounter load() const
+			{
+				return {
+					_DispatchCount.load(std::memory_order_relaxed),
+					_HandlerCount.load(std::memory_order_relaxed),
+					_Nanoseconds.load(std::memory_order_relaxed)
+				};
+			}
+			void reset()
+			{
+				*this = AtomicDispatchCounter{};
+			}
+		};
+
+		void addDispatchCounter(DispatchCounter& dst, DispatchCounter const& src)
+		{
+			dst.dispatchCount += src.dispatchCount;
+			dst.handlerCount += src.handlerCount;
+			dst.nanoseconds += src.nanoseconds;
+		}
+
+		void addEventTarget(InstrumentationSnapshot& snapshot, void const* eventTarget, DispatchCounter const& dispatchCounter)
+		{
+			auto it = snapshot.eventTargets.find(eventTarget);
+			if (it != snapshot.eventTargets.end())
+			{
+				addDispatchCounter(it->second, dispatchCounter);
+			}
+			else if (snapshot.eventTargets.size() < Instrumentation::MaxEventTargetCount)
+			{
+				snapshot.eventTargets.emplace(eventTarget, dispatchCounter);
+			}
+			else
+			{
+				addDispatchCounter(snapshot.otherEventTargets, dispatchCounter);
+			}
+		}
+
+		struct alignas(64) ThreadInstrumentation
+		{
+			AtomicHistogram _DispatchLatency;
+			AtomicHistogram _HandlerLatency;
+			AtomicHistogram _HandlerCounts;
+
+			// 표에 항목을 넣는 것은 기록하는 thread 뿐이고, 넣을 때만 잠금
+			// 기록하는 thread 는 잠금 없이 찾고, 다른 thread (snapshot(), reset()) 는 잠금 안에서 읽기만 함
+			std::mutex _Mutex;
+			FlatHashMap<EventType, AtomicDispatchCounter> _EventTypes;
+			FlatHashMap<void const*, AtomicDispatchCounter> _EventTargets;
+			AtomicDispatchCounter _OtherEventTargets;
+
+			// 이 thread 에서 진행 중인 가장 안쪽 dispatch 의 handler 호출 수
+			std::uint64_t _HandlerCount{ 0 };
+
+			AtomicDispatchCounter& eventTypeCounter(EventType const eventType)
+			{
+				if (auto dispatchCounter = _EventTypes.find(eventType))
+				{
+					return *dispatchCounter;
+				}
+
+				std::lock_guard<std::mutex> lock(_Mutex);
+				return _EventTypes[eventType];
+			}
+			AtomicDispatchCounter& eventTargetCounter(void const* eventTarget)
+			{
+				if (auto dispatchCounter = _EventTargets.find(eventTarget))
+				{
+					return *dispatchCounter;
+				}
+				if (_EventTargets.size() >= Instrumentation::MaxEventTargetCount)
+				{
+					return _OtherEventTargets;
+				}
+
+				std::lock_guard<std::mutex> lock(_Mutex);
+				return _EventTargets[eventTarget];
+			}
+
+			// _Mutex 를 잡은 채로, 또는 기록하는 thread 에서 호출
+			void mergeTo(InstrumentationSnapshot& snapshot) const
+			{
+				_DispatchLatency.mergeTo(snapshot.dispatchLatency);
+				_HandlerLatency.mergeTo(snapshot.handlerLatency);
+				_HandlerCounts.mergeTo(snapshot.handlerCounts);
+
+				// reset() 뒤 다시 기록되지 않은 항목은 표에 남아 있어도 건너뜀
+				_EventTypes.forEach(
+					[&snapshot](EventType const eventType, AtomicDispatchCounter const& dispatchCounter)
+					{
+						DispatchCounter const value = dispatchCounter.load();
+						if (value.dispatchCount)
+						{
+							addDispatchCounter(snapshot.eventTypes[eventType], value);
+						}
+					}
+				);
+				_EventTargets.forEach(
+					[&snapshot](void const* eventTarget, AtomicDispatchCounter const& dispatchCounter)
+					{
+						DispatchCounter const value = dispatchCounter.load();
+						if (value.dispatchCount)
+						{
+							addEventTarget(snapshot, eventTarget, value);
+						}
+					}
+				);
+				addDispatchCounter(snapshot.otherEventTargets, _OtherEventTargets.load());
+			}
+			// 값만 0 으로 되돌리고 표 구조는 건드리지 않음 (기록하는 thread 가 잠금 없이 찾으므로)
+			void reset()
+			{
+				_DispatchLatency.reset();
+				_HandlerLatency.reset();
+				_HandlerCounts.reset();
+
+				_EventTypes.forEach(
+					[](EventType const, AtomicDispatchCounter& dispatchCounter)
+					{
+						dispatchCounter.reset();
+					}
+				);
+				_EventTargets.forEach(
+					[](void const*, AtomicDispatchCounter& dispatchCounter)
+					{
+						dispatchCounter.reset();
+					}
+				);
+				_OtherEventTargets.reset();
+			}
+		};
+
+		// 살아 있는 thread 의 저장소 목록과, 끝난 thread 의 기록을 합친 값
+		struct InstrumentationRegistry
+		{
+			std::mutex _Mutex;
+			std::vector<ThreadInstrumentation*> _ThreadInstrumentations;
+			InstrumentationSnapshot _Retired;
+		};
+
+		InstrumentationRegistry& instrumentationRegistry()
+		{
+			static InstrumentationRegistry registry;
+			return registry;
+		}
+
+		// thread 가 끝날 때 기록을 registry 에 합치고 저장소를 해제
+		class ThreadInstrumentationOwner
+		{
+		private:
+			std::unique_ptr<ThreadInstrumentation> _ThreadInstrumentation{ std::make_unique<ThreadInstrumentation>() };
+
+		public:
+			ThreadInstrumentationOwner()
+			{
+				auto& registry = instrumentationRegistry();
+				std::lock_guard<std::mutex> lock(registry._Mutex);
+				registry._ThreadInstrumentations.push_back(_ThreadInstrumentation.get());
+			}
+			~ThreadInstrumentationOwner()
+			{
+				auto& registry = instrumentationRegistry();
+				std::lock_guard<std::mutex> lock(registry._Mutex);
+				_ThreadInstrumentation->mergeTo(registry._Retired);
+				std::erase(registry._ThreadInstrumentations, _ThreadInstrumentation.get());
+			}
+
+		public:
+			ThreadInstrumentationOwner(ThreadInstrumentationOwner const&) = delete;
+			ThreadInstrumentationOwner& operator=(ThreadInstrumentationOwner const&) = delete;
+
+		public:
+			ThreadInstrumentation& get() const
+			{
+				return *_ThreadInstrumentation;
+			}
+		};
+
+		ThreadInstrumentation& localInstrumentation()
+		{
+			thread_local ThreadInstrumentationOwner threadInstrumentationOwner;
+			return threadInstrumentationOwner.get();
+		}
+
+		std::uint64_t elapsedNanoseconds(std::chrono::steady_clock::time_point const start)
+		{
+			auto const elapsed = std::chrono::steady_clock::now() - start;
+			return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+		}
+
+		void writeJson(std::ostream& os, DispatchCounter const& dispatchCounter)
+		{
+			os
+				<< "\"dispatchCount\":" << dispatchCounter.dispatchCount
+				<< ",\"handlerCount\":" << dispatchCounter.handlerCount
+				<< ",\"nanoseconds\":" << dispatchCounter.nanoseconds;
+		}
+
+		void writeJson(std::ostream& os, Histogram const& histogram)
+		{
+			os
+				<< "{\"count\":" << histogram.totalCount()
+				<< ",\"p50\":" << histogram.percentile(0.50)
+				<< ",\"p90\":" << histogram.percentile(0.90)
+				<< ",\"p99\":" << histogram.percentile(0.99)
+				<< ",\"p999\":" << histogram.percentile(0.999)
+				<< ",\"buckets\":[";
+
+			bool first = true;
+			for (std::size_t index = 0; index < Histogram::BucketCount; index++)
+			{
+				if (histogram.count(index))
+				{
+					os << (first ? "" : ",") << "[" << Histogram::bucketValue(index) << "," << histogram.count(index) << "]";
+					first = false;
+				}
+			}
+			os << "]}";
+		}
+	}
+
+	std::string InstrumentationSnapshot::toJson() const
+	{
+		std::ostringstream os;
+
+		os << "{\"eventTypes\":[";
+		bool first = true;
+		for (auto const& [eventType, dispatchCounter] : eventTypes)
+		{
+			os << (first ? "" : ",") << "{\"eventType\":" << eventType << ",";
+			writeJson(os, dispatchCounter);
+			os << "}";
+			first = false;
+		}
+
+		os << "],\"eventTargets\":[";
+		first = true;
+		for (auto const& [eventTarget, dispatchCounter] : eventTargets)
+		{
+			os << (first ? "" : ",") << "{\"eventTarget\":\"0x" << std::hex << reinterpret_cast<std::uintptr_t>(eventTarget) << std::dec << "\",";
+			writeJson(os, dispatchCounter);
+			os << "}";
+			first = false;
+		}
+
+		os << "],\"otherEventTargets\":{";
+		writeJson(os, otherEventTargets);
+		os << "},\"dispatchLatency\":";
+		writeJson(os, dispatchLatency);
+		os << ",\"handlerLatency\":";
+		writeJson(os, handlerLatency);
+		os << ",\"handlerCounts\":";
+		writeJson(os, handlerCounts);
+		os << "}";
+
+		return os.str();
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	Instrumentation::DispatchScope::DispatchScope(EventType const eventType, void const* eventTarget, std::size_t const eventCount) :
+		_EventType(eventType),
+		_EventTarget(eventTarget),
+		_EventCount(eventCount ? eventCount : 1)
+	{
+		// 중첩 dispatch: 바깥 dispatch 의 handler 수를 보관했다가 소멸 시 되돌림
+		auto& threadInstrumentation = localInstrumentation();
+		_HandlerCount = threadInstrumentation._HandlerCount;
+		threadInstrumentation._HandlerCount = 0;
+
+		_Start = std::chrono::steady_clock::now();
+	}
+	Instrumentation::DispatchScope::~DispatchScope()
+	{
+		std::uint64_t const nanoseconds = elapsedNanoseconds(_Start);
+
+		auto& threadInstrumentation = localInstrumentation();
+		std::uint64_t const handlerCount = threadInstrumentation._HandlerCount;
+		threadInstrumentation._HandlerCount = _HandlerCount;
+
+		// 여러 Event 를 한 번에 dispatch 한 구간은 Event 당 평균으로 기록
+		threadInstrumentation._DispatchLatency.record(nanoseconds / _EventCount);
+		threadInstrumentation._HandlerCounts.record(handlerCount / _EventCount);
+
+		DispatchCounter const dispatchCounter{ _EventCount, handlerCount, nanoseconds };
+
+		threadInstrumentation.eventTypeCounter(_EventType).add(dispatchCounter);
+		if (_EventTarget)
+		{
+			threadInstrumentation.eventTargetCounter(_EventTarget).add(dispatchCounter);
+		}
+	}
+	Instrumentation::HandlerScope::HandlerScope() :
+		_Start(std::chrono::steady_clock::now())
+	{
+	}
+	Instrumentation::HandlerScope::~HandlerScope()
+	{
+		std::uint64_t const nanoseconds = elapsedNanoseconds(_Start);
+
+		auto& threadInstrumentation = localInstrumentation();
+		threadInstrumentation._HandlerLatency.record(nanoseconds);
+		threadInstrumentation._HandlerCount++;
+	}
+	InstrumentationSnapshot Instrumentation::snapshot()
+	{
+		auto& registry = instrumentationRegistry();
+		std::lock_guard<std::mutex> registryLock(registry._Mutex);
+
+		InstrumentationSnapshot snapshot = registry._Retired;
+		for (auto const threadInstrumentation : registry._ThreadInstrumentations)
+		{
+			std::lock_guard<std::mutex> lock(threadInstrumentation->_Mutex);
+			threadInstrumentation->mergeTo(snapshot);
+		}
+		return snapshot;
+	}
+	void Instrumentation::reset()
+	{
+		auto& registry = instrumentationRegistry();
+		std::lock_guard<std::mutex> registryLock(registry._Mutex);
+
+		registry._Retired = InstrumentationSnapshot{};
+		for (auto const threadInstrumentation : registry._ThreadInstrumentations)
+		{
+			std::lock_guard<std::mutex> lock(threadInstrumentation->_Mutex);
+			threadInstrumentation->reset();
+		}
+	}
+}
+#endif
+
+
+
+
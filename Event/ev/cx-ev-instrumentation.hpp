@@ -0,0 +1,148 @@
+﻿#pragma once
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// CX_EV_INSTRUMENTATION 을 정의하고 빌드하면 dispatch 통계를 수집
+// 정의하지 않으면 아래 매크로는 빈 문장이 되어 비용 없음
+#if defined(CX_EV_INSTRUMENTATION)
+#define CX_EV_INSTRUMENT_DISPATCH(eventType, eventTarget, eventCount) \
+	::cx::ev::Instrumentation::DispatchScope _InstrumentationDispatchScope{ (eventType), (eventTarget), (eventCount) }
+#define CX_EV_INSTRUMENT_HANDLER() \
+	::cx::ev::Instrumentation::HandlerScope _InstrumentationHandlerScope{}
+#else
+#define CX_EV_INSTRUMENT_DISPATCH(eventType, eventTarget, eventCount) ((void)0)
+#define CX_EV_INSTRUMENT_HANDLER() ((void)0)
+#endif
+
+
+
+
+
+#if defined(CX_EV_INSTRUMENTATION)
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// HDR 방식 log-linear histogram: 2 의 거듭제곱 구간마다 SubBucketCount 개로 나눔, 상대 오차 1/SubBucketCount 이하
+	class Histogram
+	{
+	public:
+		static constexpr std::size_t SubBucketBits = 4;
+		static constexpr std::size_t SubBucketCount = std::size_t{ 1 } << SubBucketBits;
+		static constexpr std::size_t BucketCount = SubBucketCount + (64 - SubBucketBits) * SubBucketCount;
+
+	private:
+		std::array<std::uint64_t, BucketCount> _Counts{};
+		std::uint64_t _TotalCount{ 0 };
+
+	public:
+		static std::size_t bucketIndex(std::uint64_t const value);
+		// 구간의 하한 값
+		static std::uint64_t bucketValue(std::size_t const index);
+
+	public:
+		void record(std::uint64_t const value, std::uint64_t const count = 1);
+		void merge(std::size_t const index, std::uint64_t const count);
+
+	public:
+		std::uint64_t count(std::size_t const index) const;
+		std::uint64_t totalCount() const;
+		// quantile: 0.0 ~ 1.0
+		std::uint64_t percentile(double const quantile) const;
+	};
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	struct DispatchCounter
+	{
+		std::uint64_t dispatchCount{ 0 };
+		std::uint64_t handlerCount{ 0 };
+		std::uint64_t nanoseconds{ 0 };
+	};
+
+	struct InstrumentationSnapshot
+	{
+		std::map<EventType, DispatchCounter> eventTypes;
+		std::map<void const*, DispatchCounter> eventTargets;
+		// eventTargets 가 Instrumentation::MaxEventTargetCount 에 이른 뒤 새로 나타난 EventTarget 의 합계
+		DispatchCounter otherEventTargets;
+		Histogram dispatchLatency;  // ns, dispatch 1 회
+		Histogram handlerLatency;   // ns, handler 1 회
+		Histogram handlerCounts;    // dispatch 1 회에 호출된 handler 수
+
+		std::string toJson() const;
+	};
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// thread 별 cache line 정렬 저장소에 기록하고 snapshot() 에서 모든 thread 의 값을 합침
+	// - histogram, counter: 기록하는 thread 만 쓰는 atomic, 잠금 없음
+	// - EventType/EventTarget 별 표: 처음 보는 항목을 넣을 때만 thread 별 mutex 를 잡음 (snapshot() 과만 경합)
+	// - EventTarget 은 thread 마다 MaxEventTargetCount 개까지만 따로 세고, 그 뒤는 otherEventTargets 로 합침
+	// - thread 가 끝나면 그 thread 의 기록을 합쳐 두고 저장소를 해제
+	class Instrumentation
+	{
+	public:
+		static constexpr std::size_t MaxEventTargetCount = 1024;
+
+	public:
+		class DispatchScope
+		{
+		private:
+			EventType _EventType;
+			void const* _EventTarget;
+			std::size_t _EventCount;
+			std::uint64_t _HandlerCount;
+			std::chrono::steady_clock::time_point _Start;
+
+		public:
+			DispatchScope(EventType const eventType, void const* eventTarget, std::size_t const eventCount);
+
+		public:
+			~DispatchScope();
+
+		public:
+			DispatchScope(DispatchScope const&) = delete;
+			DispatchScope& operator=(DispatchScope const&) = delete;
+		};
+
+		class HandlerScope
+		{
+		private:
+			std::chrono::steady_clock::time_point _Start;
+
+		public:
+			HandlerScope();
+
+		public:
+			~HandlerScope();
+
+		public:
+			HandlerScope(HandlerScope const&) = delete;
+			HandlerScope& operator=(HandlerScope const&) = delete;
+		};
+
+	public:
+		static InstrumentationSnapshot snapshot();
+		static void reset();
+	};
+}
+#endif
+
+
+
+
@@ -12,38 +12,359 @@
 //===========================================================================
 namespace cx::ev::key
 {
-	void EventListener::attach(Key const& key, EventHandler const& eventHandler)
+	Subscription::Subscription(std::weak_ptr<EventListener> eventListener, Key const key, EventListener::Generation const generation) :
+		_EventListener(std::move(eventListener)),
+		_Key(key),
+		_Generation(generation)
 	{
-		_EventHandlers[key] = eventHandler;
+	}
+	Subscription::Subscription(
+		std::weak_ptr<EventDispatcher*> eventDispatcher,
+		EventType const eventType,
+		std::weak_ptr<EventListener> eventListener,
+		Key const key,
+		EventListener::Generation const generation
+	) :
+		_EventListener(std::move(eventListener)),
+		_EventDispatcher(std::move(eventDispatcher)),
+		_EventType(eventType),
+		_Key(key),
+		_Generation(generation)
+	{
+	}
+	Subscription::~Subscription()
+	{
+		reset();
+	}
+	Subscription::Subscription(Subscription&& other) noexcept :
+		_EventListener(std::move(other._EventListener)),
+		_EventDispatcher(std::move(other._EventDispatcher)),
+		_EventType(other._EventType),
+		_Key(other._Key),
+		_Generation(other._Generation)
+	{
+		other.release();
+	}
+	Subscription& Subscription::operator=(Subscription&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			_EventListener = std::move(other._EventListener);
+			_EventDispatcher = std::move(other._EventDispatcher);
+			_EventType = other._EventType;
+			_Key = other._Key;
+			_Generation = other._Generation;
+			other.release();
+		}
+		return *this;
+	}
+	Subscription::operator bool() const
+	{
+		return !_EventListener.expired();
+	}
+	void Subscription::reset()
+	{
+		auto eventListener = _EventListener.lock();
+		auto eventDispatcher = _EventDispatcher.lock();
+		release();
+
+		if (!eventListener)
+		{
+			return;
+		}
+		if (eventDispatcher)
+		{
+			(*eventDispatcher)->unsubscribeEventHandler(_EventType, eventListener, _Key, _Generation);
+			return;
+		}
+		eventListener->detach(_Key, _Generation);
+	}
+	void Subscription::release()
+	{
+		_EventListener.reset();
+		_EventDispatcher.reset();
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::key
+{
+	EventListener::NotifyScope::NotifyScope(EventListener& eventListener) :
+		_EventListener(eventListener)
+	{
+		_EventListener._NotifyDepth++;
+	}
+	EventListener::NotifyScope::~NotifyScope()
+	{
+		if (--_EventListener._NotifyDepth == 0)
+		{
+			_EventListener.applyPendingChanges();
+		}
+	}
+	void EventListener::attach(Key const& key, EventHandler const& eventHandler, EventHandlerPriority const priority)
+	{
+		if (!eventHandler)
+		{
+			detach(key);
+			return;
+		}
+
+		Generation const generation = ++_LastGeneration;
+		if (_NotifyDepth)
+		{
+			detach(key);
+			_PendingAttachments.push_back({ key, priority, generation, eventHandler });
+			return;
+		}
+
+		// 교체된 handler 는 배열 정리가 끝난 뒤 (함수를 나갈 때) 소멸
+		EventHandler previous = attachNow(key, eventHandler, priority, generation);
+	}
+	Subscription EventListener::subscribe(Key const& key, EventHandler const& eventHandler, EventHandlerPriority const priority)
+	{
+		attach(key, eventHandler, priority);
+		return Subscription{ weak_from_this(), key, generation(key) };
+	}
+	EventListener::Generation EventListener::generation(Key const& key) const
+	{
+		auto it = _EventHandlerIndices.find(key);
+		if (it != _EventHandlerIndices.end())
+		{
+			return _Generations[it->second];
+		}
+
+		// notify 중 attach 는 같은 Key 의 이전 것을 지우고 넣으므로 Key 마다 하나뿐
+		for (auto const& pendingAttachment : _PendingAttachments)
+		{
+			if (pendingAttachment._Key == key)
+			{
+				return pendingAttachment._Generation;
+			}
+		}
+		return 0;
+	}
+	bool EventListener::detach(Key const& key, Generation const generation)
+	{
+		if (generation == 0 || this->generation(key) != generation)
+		{
+			return false;
+		}
+		detach(key);
+		return true;
 	}
 	void EventListener::detach(Key const& key)
 	{
-		_EventHandlers.erase(key);
+		if (_NotifyDepth)
+		{
+			std::erase_if(_PendingAttachments,
+				[&key](PendingAttachment const& pendingAttachment)
+				{
+					return pendingAttachment._Key == key;
+				}
+			);
+		}
+
+		auto it = _EventHandlerIndices.find(key);
+		if (it == _EventHandlerIndices.end())
+		{
+			return;
+		}
+
+		std::size_t const index = it->second;
+		_EventHandlerIndices.erase(it);
+		_Detached[index] = 1;
+		_DetachedCount++;
+
+		if (_NotifyDepth)
+		{
+			_PendingResets.push_back(index);
+			return;
+		}
+
+		// handler 소멸자가 이 EventListener 를 다시 detach 할 수 있으므로 배열 정리가 끝난 뒤 (함수를 나갈 때) 소멸
+		EventHandler eventHandler = std::move(_EventHandlers[index]);
+		if (_DetachedCount * 2 > _EventHandlers.size())
+		{
+			compact();
+		}
 	}
 	void EventListener::clear()
 	{
+		if (_NotifyDepth)
+		{
+			for (std::size_t i = 0; i < _EventHandlers.size(); i++)
+			{
+				if (!_Detached[i])
+				{
+					_Detached[i] = 1;
+					_DetachedCount++;
+					_PendingResets.push_back(i);
+				}
+			}
+			_EventHandlerIndices.clear();
+			_PendingAttachments.clear();
+			return;
+		}
+
+		auto eventHandlers = std::move(_EventHandlers);
+		_Keys.clear();
+		_Priorities.clear();
 		_EventHandlers.clear();
+		_Generations.clear();
+		_Detached.clear();
+		_EventHandlerIndices.clear();
+		_DetachedCount = 0;
 	}
 	bool EventListener::empty() const
 	{
-		return _EventHandlers.empty();
+		return _EventHandlerIndices.empty() && _PendingAttachments.empty();
 	}
 	void EventListener::notify(Event& event)
 	{
-		for (const auto& [eventTarget, eventHandler] : _EventHandlers)
+		NotifyScope notifyScope{ *this };
+
+		// notify 중에는 배열 크기와 위치가 바뀌지 않음
+		for (std::size_t i = 0; i < _EventHandlers.size(); i++)
 		{
-			eventHandler(event);
+			if (_Detached[i])
+			{
+				continue;
+			}
+			{
+				CX_EV_INSTRUMENT_HANDLER();
+				_EventHandlers[i](event);
+			}
 			if (event.handled())
 			{
 				break;
 			}
 		}
 	}
+	void EventListener::notify(std::span<Event> events)
+	{
+		for (auto& event : events)
+		{
+			notify(event);
+		}
+	}
 	void EventListener::notify(EventType const eventType, std::shared_ptr<EventData> eventData)
 	{
 		Event event{ eventType, eventData };
 		notify(event);
 	}
+	void EventListener::insert(Key const& key, EventHandler const& eventHandler, EventHandlerPriority const priority, Generation const generation)
+	{
+		// 같은 priority 의 마지막 뒤에 삽입, 대부분은 끝에 붙이는 것으로 끝남
+		auto const position = std::partition_point(_Priorities.begin(), _Priorities.end(),
+			[priority](EventHandlerPriority const other)
+			{
+				return other >= priority;
+			}
+		);
+		std::size_t const index = static_cast<std::size_t>(position - _Priorities.begin());
+
+		_Keys.insert(_Keys.begin() + index, key);
+		_Priorities.insert(position, priority);
+		_EventHandlers.insert(_EventHandlers.begin() + index, eventHandler);
+		_Generations.insert(_Generations.begin() + index, generation);
+		_Detached.insert(_Detached.begin() + index, 0);
+		for (std::size_t i = index + 1; i < _EventHandlers.size(); i++)
+		{
+			if (!_Detached[i])
+			{
+				_EventHandlerIndices[_Keys[i]] = i;
+			}
+		}
+		_EventHandlerIndices[key] = index;
+	}
+	EventHandler EventListener::attachNow(Key const& key, EventHandler const& eventHandler, EventHandlerPriority const priority, Generation const generation)
+	{
+		auto it = _EventHandlerIndices.find(key);
+		if (it == _EventHandlerIndices.end())
+		{
+			insert(key, eventHandler, priority, generation);
+			return nullptr;
+		}
+
+		std::size_t const index = it->second;
+		if (_Priorities[index] == priority)
+		{
+			_Generations[index] = generation;
+			return std::exchange(_EventHandlers[index], eventHandler);
+		}
+
+		_EventHandlerIndices.erase(it);
+		_Detached[index] = 1;
+		_DetachedCount++;
+		EventHandler previous = std::move(_EventHandlers[index]);
+		insert(key, eventHandler, priority, generation);
+		return previous;
+	}
+	void EventListener::applyPendingChanges()
+	{
+		// detach 된 handler 의 소멸자가 이 EventListener 를 다시 attach/detach 할 수 있음
+		// 적용하는 동안에도 notify 중으로 취급해 그런 변경은 미뤄 두고, 배열 정리가 끝난 뒤 handler 를 소멸시킨 다음 다시 적용
+		while (!_PendingResets.empty() || !_PendingAttachments.empty())
+		{
+			std::vector<EventHandler> eventHandlers;
+
+			_NotifyDepth++;
+			for (auto const index : _PendingResets)
+			{
+				eventHandlers.push_back(std::move(_EventHandlers[index]));
+			}
+			_PendingResets.clear();
+
+			auto pendingAttachments = std::move(_PendingAttachments);
+			_PendingAttachments.clear();
+			for (auto const& pendingAttachment : pendingAttachments)
+			{
+				eventHandlers.push_back(attachNow(pendingAttachment._Key, pendingAttachment._EventHandler, pendingAttachment._Priority, pendingAttachment._Generation));
+			}
+
+			if (_DetachedCount * 2 > _EventHandlers.size())
+			{
+				compact();
+			}
+
+			eventHandlers.clear();
+			_NotifyDepth--;
+		}
+	}
+	void EventListener::compact()
+	{
+		// 빈 자리를 당겨 채움, 순서는 그대로
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < _EventHandlers.size(); i++)
+		{
+			if (_Detached[i])
+			{
+				continue;
+			}
+			if (count != i)
+			{
+				_Keys[count] = _Keys[i];
+				_Priorities[count] = _Priorities[i];
+				_EventHandlers[count] = std::move(_EventHandlers[i]);
+				_Generations[count] = _Generations[i];
+				_Detached[count] = 0;
+				_EventHandlerIndices[_Keys[count]] = count;
+			}
+			count++;
+		}
+		_Keys.resize(count);
+		_Priorities.resize(count);
+		_EventHandlers.resize(count);
+		_Generations.resize(count);
+		_Detached.resize(count);
+		_DetachedCount = 0;
+	}
 }
 
 
@@ -54,49 +375,254 @@ namespace cx::ev::key
 //===========================================================================
 namespace cx::ev::key
 {
+	EventDispatcher::DispatchScope::DispatchScope(EventDispatcher& eventDispatcher) :
+		_EventDispatcher(eventDispatcher)
+	{
+		_EventDispatcher._DispatchDepth++;
+	}
+	EventDispatcher::DispatchScope::~DispatchScope()
+	{
+		if (--_EventDispatcher._DispatchDepth == 0 && !_EventDispatcher._RetiredEventListeners.empty())
+		{
+			auto retiredEventListeners = std::move(_EventDispatcher._RetiredEventListeners);
+			_EventDispatcher._RetiredEventListeners.clear();
+		}
+	}
 	void EventDispatcher::registerEventListener(EventType const eventType, std::shared_ptr<EventListener> eventListener)
 	{
-		_EventListenerMap[eventType] = eventListener;
+		if (isDirectEventType(eventType))
+		{
+			std::size_t const index = static_cast<std::size_t>(eventType);
+			if (_EventListenerTable.size() <= index)
+			{
+				_EventListenerTable.resize(index + 1);
+			}
+			retireEventListener(std::exchange(_EventListenerTable[index], std::move(eventListener)));
+			return;
+		}
+		retireEventListener(std::exchange(_EventListenerMap[eventType], std::move(eventListener)));
 	}
 	void EventDispatcher::unregisterEventListener(EventType const eventType)
 	{
-		_EventListenerMap.erase(eventType);
+		if (isDirectEventType(eventType))
+		{
+			std::size_t const index = static_cast<std::size_t>(eventType);
+			if (index < _EventListenerTable.size())
+			{
+				retireEventListener(std::move(_EventListenerTable[index]));
+			}
+			return;
+		}
+
+		auto eventListener = _EventListenerMap.find(eventType);
+		if (eventListener)
+		{
+			retireEventListener(std::move(*eventListener));
+			_EventListenerMap.erase(eventType);
+		}
+	}
+	void EventDispatcher::registerEventHandler(EventType const eventType, Key const key, EventHandler const& eventHandler, EventHandlerPriority const priority)
+	{
+		auto eventListener = findEventListener(eventType);
+		if (!eventListener)
+		{
+			auto newEventListener = std::allocate_shared<EventListener>(PoolAllocator<EventListener>{});
+			registerEventListener(eventType, newEventListener);
+			eventListener = newEventListener.get();
+		}
+		eventListener->attach(key, eventHandler, priority);
+
+		auto& eventTypes = _KeyEventTypes[key];
+		if (std::find(eventTypes.begin(), eventTypes.end(), eventType) == eventTypes.end())
+		{
+			eventTypes.push_back(eventType);
+		}
 	}
 	void EventDispatcher::unregisterEventHandler(Key const key)
 	{
-		std::vector<EventType> eventTypes;
-		for (auto& [eventType, eventListener] : _EventListenerMap)
+		auto eventTypes = _KeyEventTypes.find(key);
+		if (eventTypes)
 		{
-			if (eventListener)
+			// handler 소멸자가 다시 등록/해제해도 순회가 깨지지 않도록 먼저 꺼내 둠
+			auto keyEventTypes = std::move(*eventTypes);
+			_KeyEventTypes.erase(key);
+			for (auto const eventType : keyEventTypes)
 			{
-				eventListener->detach(key);
-				if (eventListener->empty())
+				// detach 로 소멸되는 handler 가 이 EventType 을 해제할 수 있으므로 강한 참조로 잡아 둠
+				auto eventListener = getEventListener(eventType);
+				if (eventListener)
 				{
-					eventTypes.push_back(eventType);
+					eventListener->detach(key);
+					if (eventListener->empty())
+					{
+						unregisterEventListener(eventType);
+					}
 				}
 			}
 		}
-		for (const auto& eventType : eventTypes)
+
+		auto const pattern = std::remove_if(_PatternEventHandlers.begin(), _PatternEventHandlers.end(),
+			[key](PatternEventHandler const& patternEventHandler)
+			{
+				return patternEventHandler._Key == key;
+			}
+		);
+		if (pattern != _PatternEventHandlers.end())
 		{
-			_EventListenerMap.erase(eventType);
+			_PatternEventHandlers.erase(pattern, _PatternEventHandlers.end());
+			rebuildPatternEventListeners();
+		}
+	}
+	Subscription EventDispatcher::subscribeEventHandler(EventType const eventType, Key const key, EventHandler const& eventHandler, EventHandlerPriority const priority)
+	{
+		registerEventHandler(eventType, key, eventHandler, priority);
+
+		auto eventListener = getEventListener(eventType);
+		if (!eventListener)
+		{
+			return Subscription{};
 		}
+		return Subscription{ _Self, eventType, eventListener, key, eventListener->generation(key) };
+	}
+	void EventDispatcher::unsubscribeEventHandler(EventType const eventType, std::shared_ptr<EventListener> const& eventListener, Key const key, EventListener::Generation const generation)
+	{
+		if (!eventListener->detach(key, generation))
+		{
+			return;
+		}
+
+		// 구독 뒤 registerEventListener 로 EventListener 가 바뀌었으면 지금 EventListener 의 기록은 건드리지 않음
+		if (findEventListener(eventType) != eventListener.get())
+		{
+			return;
+		}
+
+		auto eventTypes = _KeyEventTypes.find(key);
+		if (eventTypes)
+		{
+			std::erase(*eventTypes, eventType);
+			if (eventTypes->empty())
+			{
+				_KeyEventTypes.erase(key);
+			}
+		}
+		if (eventListener->empty())
+		{
+			unregisterEventListener(eventType);
+		}
+	}
+	void EventDispatcher::registerEventHandler(EventTypeRange const& eventTypes, Key const key, EventHandler const& eventHandler, EventHandlerPriority const priority)
+	{
+		// 같은 Key, 같은 범위는 교체, 빈 eventHandler 는 해제
+		auto pattern = std::find_if(_PatternEventHandlers.begin(), _PatternEventHandlers.end(),
+			[&eventTypes, key](PatternEventHandler const& patternEventHandler)
+			{
+				return patternEventHandler._Key == key && patternEventHandler._EventTypes == eventTypes;
+			}
+		);
+		if (pattern != _PatternEventHandlers.end())
+		{
+			_PatternEventHandlers.erase(pattern);
+		}
+		if (eventHandler && eventTypes.begin < eventTypes.end)
+		{
+			_PatternEventHandlers.push_back({ eventTypes, key, priority, eventHandler });
+		}
+		rebuildPatternEventListeners();
 	}
 	std::shared_ptr<EventListener> EventDispatcher::getEventListener(EventType const eventType)
 	{
-		auto it = _EventListenerMap.find(eventType);
-		if (it != _EventListenerMap.end())
+		if (isDirectEventType(eventType))
+		{
+			std::size_t const index = static_cast<std::size_t>(eventType);
+			if (index < _EventListenerTable.size())
+			{
+				return _EventListenerTable[index];
+			}
+			return nullptr;
+		}
+
+		auto eventListener = _EventListenerMap.find(eventType);
+		if (eventListener)
+		{
+			return *eventListener;
+		}
+		return nullptr;
+	}
+	EventListener* EventDispatcher::findEventListener(EventType const eventType) const
+	{
+		if (isDirectEventType(eventType))
 		{
-			return it->second;
+			std::size_t const index = static_cast<std::size_t>(eventType);
+			if (index < _EventListenerTable.size())
+			{
+				return _EventListenerTable[index].get();
+			}
+			return nullptr;
+		}
+
+		auto eventListener = _EventListenerMap.find(eventType);
+		if (eventListener)
+		{
+			return eventListener->get();
 		}
 		return nullptr;
 	}
 	void EventDispatcher::dispatchEvent(EventType const eventType, Event& event)
 	{
-		auto eventListener = getEventListener(eventType);
+		CX_EV_INSTRUMENT_DISPATCH(eventType, nullptr, 1);
+		DispatchScope dispatchScope{ *this };
+
+		auto eventListener = findEventListener(eventType);
 		if (eventListener)
 		{
 			eventListener->notify(event);
 		}
+		if (!_PatternEventHandlers.empty())
+		{
+			dispatchPatternEvent(eventType, event);
+		}
+	}
+	void EventDispatcher::dispatchEvents(std::span<Event> events)
+	{
+		DispatchScope dispatchScope{ *this };
+
+		std::size_t begin = 0;
+		while (begin < events.size())
+		{
+			EventType const eventType = events[begin].eventType();
+
+			std::size_t end = begin + 1;
+			while (end < events.size() && events[end].eventType() == eventType)
+			{
+				end++;
+			}
+
+			{
+				CX_EV_INSTRUMENT_DISPATCH(eventType, nullptr, end - begin);
+
+				std::size_t eventListenerVersion = _EventListenerVersion;
+				auto eventListener = findEventListener(eventType);
+				for (std::size_t i = begin; i < end; i++)
+				{
+					// handler 가 EventListener 를 등록/해제했으면 남은 이벤트는 바뀐 EventListener 로 통지
+					if (eventListenerVersion != _EventListenerVersion)
+					{
+						eventListenerVersion = _EventListenerVersion;
+						eventListener = findEventListener(eventType);
+					}
+					if (eventListener)
+					{
+						eventListener->notify(events[i]);
+					}
+					if (!_PatternEventHandlers.empty())
+					{
+						dispatchPatternEvent(eventType, events[i]);
+					}
+				}
+			}
+			begin = end;
+		}
 	}
 	void EventDispatcher::notifyEvent(EventType const eventType, Event& event)
 	{
@@ -107,6 +633,51 @@ namespace cx::ev::key
 		Event event{ eventType, eventData };
 		notifyEvent(eventType, event);
 	}
+	void EventDispatcher::notifyEvents(std::span<Event> events)
+	{
+		dispatchEvents(events);
+	}
+	void EventDispatcher::dispatchPatternEvent(EventType const eventType, Event& event)
+	{
+		if (event.handled())
+		{
+			return;
+		}
+
+		auto eventListener = _PatternEventListeners.find(eventType);
+		if (eventListener)
+		{
+			eventListener->notify(event);
+		}
+	}
+	void EventDispatcher::rebuildPatternEventListeners()
+	{
+		_PatternEventListeners.rebuild(_PatternEventHandlers,
+			[](EventListener& eventListener, PatternEventHandler const& patternEventHandler)
+			{
+				eventListener.attach(patternEventHandler._Key, patternEventHandler._EventHandler, patternEventHandler._Priority);
+			},
+			[this](std::shared_ptr<EventListener> eventListener)
+			{
+				retireEventListener(std::move(eventListener));
+			}
+		);
+	}
+	void EventDispatcher::retireEventListener(std::shared_ptr<EventListener> eventListener)
+	{
+		// EventListener 를 바꾸거나 지우는 곳은 모두 여기를 거침
+		_EventListenerVersion++;
+
+		// notify 중인 EventListener 가 소멸되지 않도록 가장 바깥 dispatch 가 끝날 때까지 보관
+		if (_DispatchDepth && eventListener)
+		{
+			_RetiredEventListeners.push_back(std::move(eventListener));
+		}
+	}
+	bool EventDispatcher::isDirectEventType(EventType const eventType)
+	{
+		return 0 <= eventType && eventType < DirectEventTypeLimit;
+	}
 }
 
 
@@ -124,16 +695,29 @@ namespace cx::ev::key
 	void EventHandlerRegistry::registerEventHandler(
 		EventType const eventType,
 		Key const key,
-		EventHandler const& eventHandler
+		EventHandler const& eventHandler,
+		EventHandlerPriority const priority
 	)
 	{
-		auto eventListener = _EventDispatcher.getEventListener(eventType);
-		if (!eventListener)
-		{
-			eventListener = std::make_shared<EventListener>();
-			_EventDispatcher.registerEventListener(eventType, eventListener);
-		}
-		eventListener->attach(key, eventHandler);
+		_EventDispatcher.registerEventHandler(eventType, key, eventHandler, priority);
+	}
+	void EventHandlerRegistry::registerEventHandler(
+		EventTypeRange const& eventTypes,
+		Key const key,
+		EventHandler const& eventHandler,
+		EventHandlerPriority const priority
+	)
+	{
+		_EventDispatcher.registerEventHandler(eventTypes, key, eventHandler, priority);
+	}
+	Subscription EventHandlerRegistry::subscribeEventHandler(
+		EventType const eventType,
+		Key const key,
+		EventHandler const& eventHandler,
+		EventHandlerPriority const priority
+	)
+	{
+		return _EventDispatcher.subscribeEventHandler(eventType, key, eventHandler, priority);
 	}
 	void EventHandlerRegistry::unregisterEventHandler(Key const key)
 	{
@@ -15,14 +15,71 @@ namespace cx::ev::key
 //===========================================================================
 namespace cx::ev::key
 {
-	class EventListener
+	class Subscription;
+	class EventDispatcher;
+
+	class EventListener : public std::enable_shared_from_this<EventListener>
 	{
+	public:
+		// attach 할 때마다 새로 매기는 번호 (0 은 붙어 있지 않음)
+		// 같은 Key 로 다시 attach 된 handler 를 이전 Subscription 이 떼어내지 않도록 구분
+		using Generation = std::uint64_t;
+
+	private:
+		struct PendingAttachment
+		{
+			Key _Key;
+			EventHandlerPriority _Priority;
+			Generation _Generation;
+			EventHandler _EventHandler;
+		};
+
+		// notify 중첩 깊이를 세고, 가장 바깥 notify 가 끝날 때 미뤄둔 변경을 적용
+		class NotifyScope
+		{
+		private:
+			EventListener& _EventListener;
+
+		public:
+			explicit NotifyScope(EventListener& eventListener);
+
+		public:
+			~NotifyScope();
+
+		public:
+			NotifyScope(NotifyScope const&) = delete;
+			NotifyScope& operator=(NotifyScope const&) = delete;
+		};
+
 	private:
-		std::unordered_map<Key, EventHandler> _EventHandlers;
+		// priority 내림차순으로 정렬된 조밀한 배열, 정렬은 attach 에서만 함
+		// detach 된 자리는 _Detached 로 표시해 순서를 유지하고, 빈 자리가 절반을 넘으면 compact()
+		std::vector<Key> _Keys;
+		std::vector<EventHandlerPriority> _Priorities;
+		std::vector<EventHandler> _EventHandlers;
+		std::vector<Generation> _Generations;
+		std::vector<std::uint8_t> _Detached;
+		std::unordered_map<Key, std::size_t> _EventHandlerIndices;
+		std::size_t _DetachedCount{ 0 };
+		Generation _LastGeneration{ 0 };
+
+		// notify 중(handler 안)의 attach/detach/clear 는 배열을 옮기지 않음
+		// - detach: 표시만 하고 handler 소멸은 _PendingResets 로 미룸 (실행 중인 handler 를 지우지 않도록)
+		// - attach: _PendingAttachments 에 모았다가 가장 바깥 notify 가 끝날 때 붙임
+		std::size_t _NotifyDepth{ 0 };
+		std::vector<PendingAttachment> _PendingAttachments;
+		std::vector<std::size_t> _PendingResets;
 
 	public:
-		void attach(Key const& key, EventHandler const& eventHandler);
+		// 빈 eventHandler 를 attach 하면 detach 와 같음
+		void attach(Key const& key, EventHandler const& eventHandler, EventHandlerPriority const priority = 0);
 		void detach(Key const& key);
+		// key 에 붙어 있는 handler 의 Generation 이 generation 과 같을 때만 detach, detach 했으면 true
+		bool detach(Key const& key, Generation const generation);
+		// shared_ptr 로 소유된 EventListener 에서만 사용 가능
+		[[nodiscard]] Subscription subscribe(Key const& key, EventHandler const& eventHandler, EventHandlerPriority const priority = 0);
+		// key 에 붙어 있는 (notify 중이면 붙일 예정인) handler 의 Generation, 없으면 0
+		Generation generation(Key const& key) const;
 
 	public:
 		void clear();
@@ -30,7 +87,71 @@ namespace cx::ev::key
 
 	public:
 		void notify(Event& event);
+		void notify(std::span<Event> events);
 		void notify(EventType const eventType, std::shared_ptr<EventData> eventData);
+		template<typename TEvent> void notify(typename TEvent::PayloadType const& eventPayload);
+
+	private:
+		// 교체되거나 떼어낸 이전 handler 를 반환, 호출한 쪽에서 배열 정리가 끝난 뒤 소멸시킴
+		EventHandler attachNow(Key const& key, EventHandler const& eventHandler, EventHandlerPriority const priority, Generation const generation);
+		void insert(Key const& key, EventHandler const& eventHandler, EventHandlerPriority const priority, Generation const generation);
+		void applyPendingChanges();
+		void compact();
+	};
+
+	template<typename TEvent>
+	void EventListener::notify(typename TEvent::PayloadType const& eventPayload)
+	{
+		Event event{ TEvent::eventType, &eventPayload };
+		notify(event);
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::key
+{
+	// EventListener 에 붙인 Key 의 수명을 범위에 묶는 handle
+	// 이동만 가능, 소멸 시 detach. EventListener 가 먼저 사라졌거나 이미 detach 된 경우 아무것도 하지 않음
+	// 같은 Key 로 다시 attach 된 handler 는 Generation 이 달라 건드리지 않음
+	// EventDispatcher 를 통해 구독했으면 EventDispatcher 의 기록 (Key 별 EventType, 빈 EventListener) 도 함께 정리
+	class Subscription
+	{
+	private:
+		std::weak_ptr<EventListener> _EventListener;
+		std::weak_ptr<EventDispatcher*> _EventDispatcher;
+		EventType _EventType{};
+		Key _Key{};
+		EventListener::Generation _Generation{};
+
+	public:
+		Subscription() = default;
+		Subscription(std::weak_ptr<EventListener> eventListener, Key const key, EventListener::Generation const generation);
+		Subscription(
+			std::weak_ptr<EventDispatcher*> eventDispatcher,
+			EventType const eventType,
+			std::weak_ptr<EventListener> eventListener,
+			Key const key,
+			EventListener::Generation const generation
+		);
+
+	public:
+		~Subscription();
+
+	public:
+		Subscription(Subscription const&) = delete;
+		Subscription& operator=(Subscription const&) = delete;
+		Subscription(Subscription&& other) noexcept;
+		Subscription& operator=(Subscription&& other) noexcept;
+
+	public:
+		explicit operator bool() const;
+		void reset();
+		void release();
 	};
 }
 
@@ -44,22 +165,105 @@ namespace cx::ev::key
 {
 	class EventDispatcher
 	{
+	public:
+		// [0, DirectEventTypeLimit) 범위의 EventType 은 배열로 바로 찾고, 그 밖은 해시로 찾음
+		static constexpr EventType DirectEventTypeLimit = 1024;
+
 	private:
-		std::map<EventType, std::shared_ptr<EventListener>> _EventListenerMap;
+		struct PatternEventHandler
+		{
+			EventTypeRange _EventTypes;
+			Key _Key;
+			EventHandlerPriority _Priority;
+			EventHandler _EventHandler;
+		};
+
+		// dispatch 중첩 깊이를 세고, 가장 바깥 dispatch 가 끝날 때 _RetiredEventListeners 를 비움
+		class DispatchScope
+		{
+		private:
+			EventDispatcher& _EventDispatcher;
+
+		public:
+			explicit DispatchScope(EventDispatcher& eventDispatcher);
+
+		public:
+			~DispatchScope();
+
+		public:
+			DispatchScope(DispatchScope const&) = delete;
+			DispatchScope& operator=(DispatchScope const&) = delete;
+		};
+
+	private:
+		std::vector<std::shared_ptr<EventListener>> _EventListenerTable;
+		FlatHashMap<EventType, std::shared_ptr<EventListener>> _EventListenerMap;
+		// Key 가 붙어 있는 EventType 목록 (registerEventHandler 로 등록한 것만 추적)
+		FlatHashMap<Key, std::vector<EventType>> _KeyEventTypes;
+
+		// 범위 구독: 범위 구독이 바뀔 때 EventType 구간별 EventListener 를 다시 만듦. 범위 구독이 없으면 dispatch 비용 없음
+		std::vector<PatternEventHandler> _PatternEventHandlers;
+		PatternEventListenerTable<EventListener> _PatternEventListeners;
+
+		// dispatch 중에 해제된 EventListener 는 notify 가 끝날 때까지 여기서 살려둠
+		std::size_t _DispatchDepth{ 0 };
+		std::vector<std::shared_ptr<EventListener>> _RetiredEventListeners;
+		// EventListener 가 등록/해제될 때마다 증가, notifyEvents 는 이 값이 바뀌었을 때만 EventListener 를 다시 찾음
+		std::size_t _EventListenerVersion{ 0 };
+
+		// Subscription 이 EventDispatcher 가 살아 있는지 확인하는 데 사용, 그래서 복사/이동 불가
+		std::shared_ptr<EventDispatcher*> _Self{ std::make_shared<EventDispatcher*>(this) };
+
+	public:
+		EventDispatcher() = default;
+
+	public:
+		EventDispatcher(EventDispatcher const&) = delete;
+		EventDispatcher& operator=(EventDispatcher const&) = delete;
 
 	public:
 		void registerEventListener(EventType const eventType, std::shared_ptr<EventListener> eventListener);
 		void unregisterEventListener(EventType const eventType);
+		void registerEventHandler(EventType const eventType, Key const key, EventHandler const& eventHandler, EventHandlerPriority const priority = 0);
+		// eventTypes 범위의 모든 EventType 에 등록, EventTypeRange::all() 은 모든 EventType
+		// 정확한 EventType 으로 등록한 handler 가 먼저 호출되고, 이어서 범위 구독 handler 가 priority 순으로 호출됨
+		void registerEventHandler(EventTypeRange const& eventTypes, Key const key, EventHandler const& eventHandler, EventHandlerPriority const priority = 0);
+		// Key 로 등록한 모든 handler (범위 구독 포함) 를 해제
 		void unregisterEventHandler(Key const key);
+		// Subscription 이 소멸될 때 이 EventType 의 handler 만 해제, 그 사이 같은 Key 로 다시 등록된 handler 는 그대로 둠
+		[[nodiscard]] Subscription subscribeEventHandler(EventType const eventType, Key const key, EventHandler const& eventHandler, EventHandlerPriority const priority = 0);
 		std::shared_ptr<EventListener> getEventListener(EventType const eventType);
+		EventListener* findEventListener(EventType const eventType) const;
 
 	protected:
 		void dispatchEvent(EventType const eventType, Event& event);
+		void dispatchEvents(std::span<Event> events);
 
 	public:
 		void notifyEvent(EventType const eventType, Event& event);
+		// events 를 차례로 notifyEvent 한 것과 같은 순서로 통지 (이벤트마다 정확한 EventType handler, 이어서 범위 구독 handler)
+		// 같은 EventType 이 연속된 구간마다 EventListener 를 한 번만 찾고, handler 가 등록을 바꿨을 때만 다시 찾음
+		void notifyEvents(std::span<Event> events);
 		void notifyEvent(EventType const eventType, std::shared_ptr<EventData> eventData);
+		template<typename TEvent> void notifyEvent(typename TEvent::PayloadType const& eventPayload);
+
+	private:
+		friend class Subscription;
+		void unsubscribeEventHandler(EventType const eventType, std::shared_ptr<EventListener> const& eventListener, Key const key, EventListener::Generation const generation);
+
+	private:
+		void dispatchPatternEvent(EventType const eventType, Event& event);
+		void rebuildPatternEventListeners();
+		void retireEventListener(std::shared_ptr<EventListener> eventListener);
+		static bool isDirectEventType(EventType const eventType);
 	};
+
+	template<typename TEvent>
+	void EventDispatcher::notifyEvent(typename TEvent::PayloadType const& eventPayload)
+	{
+		Event event{ TEvent::eventType, &eventPayload };
+		dispatchEvent(TEvent::eventType, event);
+	}
 }
 
 
@@ -82,10 +286,31 @@ namespace cx::ev::key
 		void registerEventHandler(
 			EventType const eventType,
 			Key const key,
-			EventHandler const& eventHandler
+			EventHandler const& eventHandler,
+			EventHandlerPriority const priority = 0
+		);
+		void registerEventHandler(
+			EventTypeRange const& eventTypes,
+			Key const key,
+			EventHandler const& eventHandler,
+			EventHandlerPriority const priority = 0
+		);
+		template<typename TEvent, typename Handler>
+		void registerEventHandler(Key const key, Handler&& handler, EventHandlerPriority const priority = 0);
+		[[nodiscard]] Subscription subscribeEventHandler(
+			EventType const eventType,
+			Key const key,
+			EventHandler const& eventHandler,
+			EventHandlerPriority const priority = 0
 		);
 		void unregisterEventHandler(Key const key);
 	};
+
+	template<typename TEvent, typename Handler>
+	void EventHandlerRegistry::registerEventHandler(Key const key, Handler&& handler, EventHandlerPriority const priority)
+	{
+		registerEventHandler(TEvent::eventType, key, makeEventHandler<TEvent>(std::forward<Handler>(handler)), priority);
+	}
 }
 
 
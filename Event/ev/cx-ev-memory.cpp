@@ -0,0 +1,129 @@
+﻿/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+#include "pch.hpp"
+
+#include "cx-ev.hpp"
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	namespace
+	{
+		// thread 종료 중 pool 이 소멸된 뒤에 들어온 요청은 operator new/delete 로 처리
+		thread_local bool _MemoryPoolDestroyed{ false };
+	}
+
+	MemoryPool::~MemoryPool()
+	{
+		for (auto& sizeClass : _SizeClasses)
+		{
+			while (sizeClass._Head)
+			{
+				FreeBlock* block = sizeClass._Head;
+				sizeClass._Head = block->_Next;
+				::operator delete(block);
+			}
+			sizeClass._Count = 0;
+		}
+		_MemoryPoolDestroyed = true;
+	}
+	void* MemoryPool::allocate(std::size_t const size)
+	{
+		if (size == 0 || size > MaxBlockSize)
+		{
+			return ::operator new(size ? size : 1);
+		}
+
+		std::size_t const index = (size - 1) / Granularity;
+		MemoryPool* memoryPool = local();
+		if (memoryPool)
+		{
+			SizeClass& sizeClass = memoryPool->_SizeClasses[index];
+			if (sizeClass._Head)
+			{
+				FreeBlock* block = sizeClass._Head;
+				sizeClass._Head = block->_Next;
+				sizeClass._Count--;
+				return block;
+			}
+		}
+		return ::operator new((index + 1) * Granularity);
+	}
+	void MemoryPool::deallocate(void* block, std::size_t const size)
+	{
+		if (!block)
+		{
+			return;
+		}
+		if (size == 0 || size > MaxBlockSize)
+		{
+			::operator delete(block);
+			return;
+		}
+
+		std::size_t const index = (size - 1) / Granularity;
+		MemoryPool* memoryPool = local();
+		if (memoryPool)
+		{
+			SizeClass& sizeClass = memoryPool->_SizeClasses[index];
+			if (sizeClass._Count < MaxFreeBlocks)
+			{
+				sizeClass._Head = ::new (block) FreeBlock{ sizeClass._Head };
+				sizeClass._Count++;
+				return;
+			}
+		}
+		::operator delete(block);
+	}
+	MemoryPool* MemoryPool::local()
+	{
+		if (_MemoryPoolDestroyed)
+		{
+			return nullptr;
+		}
+
+		thread_local MemoryPool memoryPool;
+		return &memoryPool;
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	FrameArena::FrameArena(std::size_t const initialSize) :
+		_Buffer(std::make_unique<std::byte[]>(initialSize ? initialSize : 1)),
+		_MemoryResource(_Buffer.get(), initialSize ? initialSize : 1)
+	{
+	}
+	FrameArena::~FrameArena()
+	{
+		reset();
+	}
+	std::pmr::memory_resource* FrameArena::memoryResource()
+	{
+		return &_MemoryResource;
+	}
+	void FrameArena::reset()
+	{
+		for (Destructor* destructor = _Destructors; destructor; destructor = destructor->_Next)
+		{
+			destructor->_Destroy(destructor->_Object);
+		}
+		_Destructors = nullptr;
+		_MemoryResource.release();
+	}
+}
+
+
+
+
@@ -0,0 +1,166 @@
+﻿#pragma once
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// thread 별 크기 등급 free list
+	// 블록은 하나씩 operator new 로 할당하므로 다른 thread 에서 해제해도 됨 (해제한 thread 의 pool 로 들어감)
+	// MaxBlockSize 보다 큰 요청과 등급마다 MaxFreeBlocks 를 넘는 블록은 operator new/delete 로 바로 처리
+	class MemoryPool
+	{
+	public:
+		static constexpr std::size_t Granularity = 16;
+		static constexpr std::size_t MaxBlockSize = 512;
+		static constexpr std::size_t SizeClassCount = MaxBlockSize / Granularity;
+		static constexpr std::size_t MaxFreeBlocks = 256;
+
+	private:
+		struct FreeBlock
+		{
+			FreeBlock* _Next;
+		};
+
+		struct SizeClass
+		{
+			FreeBlock* _Head{ nullptr };
+			std::size_t _Count{ 0 };
+		};
+
+	private:
+		std::array<SizeClass, SizeClassCount> _SizeClasses{};
+
+	public:
+		MemoryPool() = default;
+
+	public:
+		~MemoryPool();
+
+	public:
+		MemoryPool(MemoryPool const&) = delete;
+		MemoryPool& operator=(MemoryPool const&) = delete;
+
+	public:
+		static void* allocate(std::size_t const size);
+		static void deallocate(void* block, std::size_t const size);
+
+	private:
+		static MemoryPool* local();
+	};
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// MemoryPool 을 쓰는 표준 allocator, std::allocate_shared 등에 사용
+	template<typename T>
+	class PoolAllocator
+	{
+	public:
+		using value_type = T;
+
+	public:
+		PoolAllocator() = default;
+		template<typename U>
+		PoolAllocator(PoolAllocator<U> const&) noexcept
+		{
+		}
+
+	public:
+		T* allocate(std::size_t const count)
+		{
+			static_assert(alignof(T) <= alignof(std::max_align_t));
+			return static_cast<T*>(MemoryPool::allocate(count * sizeof(T)));
+		}
+		void deallocate(T* pointer, std::size_t const count)
+		{
+			MemoryPool::deallocate(pointer, count * sizeof(T));
+		}
+	};
+
+	template<typename T, typename U>
+	bool operator==(PoolAllocator<T> const&, PoolAllocator<U> const&)
+	{
+		return true;
+	}
+	template<typename T, typename U>
+	bool operator!=(PoolAllocator<T> const&, PoolAllocator<U> const&)
+	{
+		return false;
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// frame 단위 monotonic arena
+	// create() 는 포인터 증가만으로 할당, reset() 이 생성 역순으로 소멸자를 호출하고 메모리를 한꺼번에 되돌림
+	// 초기 버퍼는 reset() 후에도 유지되므로 frame 마다 다시 할당하지 않음
+	// 한 thread 에서만 사용
+	class FrameArena
+	{
+	private:
+		struct Destructor
+		{
+			void (*_Destroy)(void*);
+			void* _Object;
+			Destructor* _Next;
+		};
+
+	private:
+		std::unique_ptr<std::byte[]> _Buffer;
+		std::pmr::monotonic_buffer_resource _MemoryResource;
+		Destructor* _Destructors{ nullptr };
+
+	public:
+		explicit FrameArena(std::size_t const initialSize = 64 * 1024);
+
+	public:
+		~FrameArena();
+
+	public:
+		FrameArena(FrameArena const&) = delete;
+		FrameArena& operator=(FrameArena const&) = delete;
+
+	public:
+		std::pmr::memory_resource* memoryResource();
+		template<typename T, typename... Args>
+		T& create(Args&&... args);
+		void reset();
+	};
+
+	template<typename T, typename... Args>
+	T& FrameArena::create(Args&&... args)
+	{
+		void* memory = _MemoryResource.allocate(sizeof(T), alignof(T));
+		T* object = ::new (memory) T(std::forward<Args>(args)...);
+
+		if constexpr (!std::is_trivially_destructible_v<T>)
+		{
+			void* destructor = _MemoryResource.allocate(sizeof(Destructor), alignof(Destructor));
+			_Destructors = ::new (destructor) Destructor{
+				[](void* object)
+				{
+					static_cast<T*>(object)->~T();
+				},
+				object,
+				_Destructors
+			};
+		}
+		return *object;
+	}
+}
+
+
+
+
@@ -0,0 +1,173 @@
+﻿/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+#include "pch.hpp"
+
+#include "cx-ev.hpp"
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	EventPropagator::EventPropagator(EventDispatcher& eventDispatcher, ParentResolver parentResolver) :
+		_EventDispatcher(eventDispatcher),
+		_ParentResolver(std::move(parentResolver))
+	{
+	}
+	EventPropagator::EventPropagator(EventDispatcher& eventDispatcher, EventDispatcher& captureEventDispatcher, ParentResolver parentResolver) :
+		_EventDispatcher(eventDispatcher),
+		_CaptureEventDispatcher(&captureEventDispatcher),
+		_ParentResolver(std::move(parentResolver))
+	{
+	}
+	void EventPropagator::notifyEvent(EventType const eventType, EventTarget const& eventTarget, Event& event, bool const bubbles)
+	{
+		// handler 안에서 경로가 무효화되어도 이번 전파는 끝까지 같은 경로를 씀
+		auto const eventPath = resolveEventPath(eventTarget);
+		void const* const target = eventTarget.get();
+
+		event.eventTarget(target);
+
+		bool stopped = false;
+		if (_CaptureEventDispatcher)
+		{
+			for (auto it = eventPath->rbegin(); !stopped && it != eventPath->rend(); ++it)
+			{
+				stopped = dispatchEvent(*_CaptureEventDispatcher, eventType, *it, EventPhase::Capture, event);
+			}
+			if (!stopped)
+			{
+				stopped = dispatchEvent(*_CaptureEventDispatcher, eventType, target, EventPhase::Target, event);
+			}
+		}
+		if (!stopped)
+		{
+			stopped = dispatchEvent(_EventDispatcher, eventType, target, EventPhase::Target, event);
+		}
+		if (bubbles)
+		{
+			for (auto it = eventPath->begin(); !stopped && it != eventPath->end(); ++it)
+			{
+				stopped = dispatchEvent(_EventDispatcher, eventType, *it, EventPhase::Bubble, event);
+			}
+		}
+
+		event.eventPhase(EventPhase::None);
+		event.currentEventTarget(nullptr);
+	}
+	void EventPropagator::notifyEvent(EventType const eventType, EventTarget const& eventTarget, std::shared_ptr<EventData> eventData, bool const bubbles)
+	{
+		Event event{ eventType, eventData };
+		notifyEvent(eventType, eventTarget, event, bubbles);
+	}
+	void EventPropagator::invalidatePath(EventTarget const& eventTarget)
+	{
+		void const* const target = eventTarget.get();
+
+		std::vector<void const*> eventTargets;
+		_EventPaths.forEach(
+			[&eventTargets, target](void const* key, EventPathEntry const& eventPathEntry)
+			{
+				auto const& eventPath = *eventPathEntry._EventPath;
+				bool const inPath = std::any_of(eventPath.begin(), eventPath.end(),
+					[target](EventPathNode const& eventPathNode)
+					{
+						return eventPathNode._Address == target;
+					}
+				);
+				if (key == target || inPath)
+				{
+					eventTargets.push_back(key);
+				}
+			}
+		);
+		for (auto const key : eventTargets)
+		{
+			_EventPaths.erase(key);
+		}
+	}
+	void EventPropagator::invalidatePaths()
+	{
+		_EventPaths.clear();
+	}
+	std::size_t EventPropagator::sweep()
+	{
+		std::vector<void const*> eventTargets;
+		_EventPaths.forEach(
+			[&eventTargets](void const* key, EventPathEntry const& eventPathEntry)
+			{
+				if (eventPathEntry._EventTarget.expired())
+				{
+					eventTargets.push_back(key);
+				}
+			}
+		);
+		for (auto const key : eventTargets)
+		{
+			_EventPaths.erase(key);
+		}
+		return eventTargets.size();
+	}
+	std::shared_ptr<EventPropagator::EventPath const> EventPropagator::resolveEventPath(EventTarget const& eventTarget)
+	{
+		auto eventPathEntry = _EventPaths.find(eventTarget.get());
+		if (eventPathEntry && !eventPathEntry->_EventTarget.expired() && isAlive(*eventPathEntry->_EventPath))
+		{
+			return eventPathEntry->_EventPath;
+		}
+
+		auto eventPath = std::allocate_shared<EventPath>(PoolAllocator<EventPath>{});
+		if (_ParentResolver)
+		{
+			for (auto parent = _ParentResolver(eventTarget); parent && eventPath->size() < MaxPathLength; parent = _ParentResolver(parent))
+			{
+				eventPath->push_back({ parent.get(), parent });
+			}
+		}
+
+		// EventTarget 수가 지난 sweep 의 두 배가 되면 만료된 항목을 정리하여 메모리를 제한
+		if (!eventPathEntry && _EventPaths.size() + 1 >= _SweepThreshold)
+		{
+			sweep();
+			_SweepThreshold = std::max<std::size_t>(64, (_EventPaths.size() + 1) * 2);
+		}
+
+		auto& entry = _EventPaths[eventTarget.get()];
+		entry._EventTarget = eventTarget;
+		entry._EventPath = eventPath;
+		return eventPath;
+	}
+	bool EventPropagator::dispatchEvent(EventDispatcher& eventDispatcher, EventType const eventType, void const* eventTarget, EventPhase const eventPhase, Event& event)
+	{
+		event.eventPhase(eventPhase);
+		event.currentEventTarget(eventTarget);
+		eventDispatcher.dispatchEvent(eventType, eventTarget, event);
+		return event.handled();
+	}
+	bool EventPropagator::dispatchEvent(EventDispatcher& eventDispatcher, EventType const eventType, EventPathNode const& eventPathNode, EventPhase const eventPhase, Event& event)
+	{
+		// 통지하는 동안 부모를 살려두고, 이미 소멸된 부모는 건너뜀
+		auto const eventTarget = eventPathNode._EventTarget.lock();
+		if (!eventTarget)
+		{
+			return false;
+		}
+		return dispatchEvent(eventDispatcher, eventType, eventPathNode._Address, eventPhase, event);
+	}
+	bool EventPropagator::isAlive(EventPath const& eventPath)
+	{
+		return std::none_of(eventPath.begin(), eventPath.end(),
+			[](EventPathNode const& eventPathNode)
+			{
+				return eventPathNode._EventTarget.expired();
+			}
+		);
+	}
+}
+
+
+
+
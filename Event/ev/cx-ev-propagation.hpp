@@ -0,0 +1,80 @@
+﻿#pragma once
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	// DOM 방식 capture → target → bubble 전파
+	// - capture: 최상위 부모부터 직계 부모까지 captureEventDispatcher 의 handler
+	// - target : 대상의 captureEventDispatcher handler, 이어서 eventDispatcher handler
+	// - bubble : 직계 부모부터 최상위 부모까지 eventDispatcher 의 handler
+	// Event::handled(true) 가 되면 그 자리에서 전파를 멈춤
+	//
+	// 부모 목록은 EventTarget 별로 한 번만 parentResolver 로 구해 약한 참조로 보관
+	// - 보관된 부모 중 하나라도 소멸되었으면 경로를 다시 구함
+	// - 전파 중에는 부모를 하나씩 lock 하여 확인하고, 그 사이 소멸된 부모는 건너뜀 (같은 주소를 재사용한 객체로 통지하지 않음)
+	// 살아 있는 부모가 바뀌면 (reparent) invalidatePath() / invalidatePaths() 를 호출할 것
+	class EventPropagator
+	{
+	public:
+		// 부모가 없으면 nullptr 반환
+		using ParentResolver = Delegate<EventTarget(EventTarget const&)>;
+		// 부모를 따라가는 최대 깊이, 순환 트리 방지
+		static constexpr std::size_t MaxPathLength = 1024;
+
+	private:
+		struct EventPathNode
+		{
+			void const* _Address;
+			WeakEventTarget _EventTarget;
+		};
+		using EventPath = std::vector<EventPathNode>;
+
+		struct EventPathEntry
+		{
+			WeakEventTarget _EventTarget;
+			// 직계 부모부터 최상위 부모 순서
+			std::shared_ptr<EventPath const> _EventPath;
+		};
+
+	private:
+		EventDispatcher& _EventDispatcher;
+		EventDispatcher* _CaptureEventDispatcher{ nullptr };
+		ParentResolver _ParentResolver;
+		FlatHashMap<void const*, EventPathEntry> _EventPaths;
+		std::size_t _SweepThreshold{ 64 };
+
+	public:
+		EventPropagator(EventDispatcher& eventDispatcher, ParentResolver parentResolver);
+		EventPropagator(EventDispatcher& eventDispatcher, EventDispatcher& captureEventDispatcher, ParentResolver parentResolver);
+
+	public:
+		void notifyEvent(EventType const eventType, EventTarget const& eventTarget, Event& event, bool const bubbles = true);
+		void notifyEvent(EventType const eventType, EventTarget const& eventTarget, std::shared_ptr<EventData> eventData, bool const bubbles = true);
+		template<typename TEvent> void notifyEvent(EventTarget const& eventTarget, typename TEvent::PayloadType const& eventPayload, bool const bubbles = true);
+
+	public:
+		// eventTarget 과, eventTarget 을 부모로 가진 모든 EventTarget 의 보관된 경로를 버림
+		void invalidatePath(EventTarget const& eventTarget);
+		void invalidatePaths();
+		// 이미 소멸된 EventTarget 의 경로를 지움
+		std::size_t sweep();
+
+	private:
+		std::shared_ptr<EventPath const> resolveEventPath(EventTarget const& eventTarget);
+		bool dispatchEvent(EventDispatcher& eventDispatcher, EventType const eventType, void const* eventTarget, EventPhase const eventPhase, Event& event);
+		bool dispatchEvent(EventDispatcher& eventDispatcher, EventType const eventType, EventPathNode const& eventPathNode, EventPhase const eventPhase, Event& event);
+		static bool isAlive(EventPath const& eventPath);
+	};
+
+	template<typename TEvent>
+	void EventPropagator::notifyEvent(EventTarget const& eventTarget, typename TEvent::PayloadType const& eventPayload, bool const bubbles)
+	{
+		Event event{ TEvent::eventType, &eventPayload };
+		notifyEvent(TEvent::eventType, eventTarget, event, bubbles);
+	}
+}
+
+
+
+
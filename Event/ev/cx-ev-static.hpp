@@ -0,0 +1,279 @@
+﻿#pragma once
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::key
+{
+	// 컴파일 시간에 정해진 TypedEvent 집합 전용 dispatcher
+	// TEvent 마다 constexpr 색인으로 자기 handler 배열을 바로 찾음: 해시 조회, Event 포장, payload 형 변환 없음
+	// handler 는 handler(PayloadType const&), 등록 순서대로 호출
+	template<typename... TEvents>
+	class StaticEventDispatcher
+	{
+	public:
+		template<typename TEvent>
+		using EventHandler = Delegate<void(typename TEvent::PayloadType const&)>;
+
+	private:
+		template<typename TEvent>
+		static constexpr std::size_t eventIndex()
+		{
+			constexpr std::array<bool, sizeof...(TEvents)> matches{ std::is_same_v<TEvent, TEvents>... };
+			for (std::size_t index = 0; index < matches.size(); index++)
+			{
+				if (matches[index])
+				{
+					return index;
+				}
+			}
+			return matches.size();
+		}
+
+		static constexpr bool isUnique()
+		{
+			constexpr std::array<EventType, sizeof...(TEvents)> eventTypes{ TEvents::eventType... };
+			for (std::size_t i = 0; i < eventTypes.size(); i++)
+			{
+				for (std::size_t j = i + 1; j < eventTypes.size(); j++)
+				{
+					if (eventTypes[i] == eventTypes[j])
+					{
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+
+		static_assert(sizeof...(TEvents) > 0, "StaticEventDispatcher needs at least one TypedEvent");
+		static_assert(isUnique(), "TypedEvent::eventType must be unique within a StaticEventDispatcher");
+
+	public:
+		template<typename TEvent>
+		static constexpr std::size_t indexOf = eventIndex<TEvent>();
+
+	private:
+		// 등록 순서대로 조밀하게 모은 배열
+		// notify 중(handler 안)의 등록/해제는 배열을 옮기지 않음
+		// - 해제: _Detached 로 표시만 하고, 가장 바깥 notify 가 끝날 때 지움 (실행 중인 handler 를 지우지 않도록)
+		// - 등록: 같은 Key 를 해제 표시하고 _PendingAttachments 에 모았다가 가장 바깥 notify 가 끝날 때 뒤에 붙임
+		template<typename TEvent>
+		class EventHandlerList
+		{
+		private:
+			struct PendingAttachment
+			{
+				Key _Key;
+				EventHandler<TEvent> _EventHandler;
+			};
+
+			class NotifyScope
+			{
+			private:
+				EventHandlerList& _EventHandlerList;
+
+			public:
+				explicit NotifyScope(EventHandlerList& eventHandlerList) :
+					_EventHandlerList(eventHandlerList)
+				{
+					_EventHandlerList._NotifyDepth++;
+				}
+				~NotifyScope()
+				{
+					if (--_EventHandlerList._NotifyDepth == 0 && _EventHandlerList.hasPendingChanges())
+					{
+						_EventHandlerList.applyPendingChanges();
+					}
+				}
+
+			public:
+				NotifyScope(NotifyScope const&) = delete;
+				NotifyScope& operator=(NotifyScope const&) = delete;
+			};
+
+		private:
+			std::vector<Key> _Keys;
+			std::vector<EventHandler<TEvent>> _EventHandlers;
+			std::vector<std::uint8_t> _Detached;
+			std::size_t _DetachedCount{ 0 };
+
+			std::size_t _NotifyDepth{ 0 };
+			std::vector<PendingAttachment> _PendingAttachments;
+
+		public:
+			void attach(Key const key, EventHandler<TEvent> eventHandler)
+			{
+				if (_NotifyDepth)
+				{
+					detach(key);
+					_PendingAttachments.push_back({ key, std::move(eventHandler) });
+					return;
+				}
+
+				// 교체된 handler 는 함수를 나갈 때 소멸
+				EventHandler<TEvent> previous = attachNow(key, std::move(eventHandler));
+			}
+			void detach(Key const key)
+			{
+				// 떼어낸 handler 는 배열 정리가 끝난 뒤 (함수를 나갈 때) 소멸
+				EventHandler<TEvent> previous;
+
+				auto pending = std::find_if(_PendingAttachments.begin(), _PendingAttachments.end(),
+					[key](PendingAttachment const& pendingAttachment)
+					{
+						return pendingAttachment._Key == key;
+					}
+				);
+				if (pending != _PendingAttachments.end())
+				{
+					previous = std::move(pending->_EventHandler);
+					_PendingAttachments.erase(pending);
+					return;
+				}
+
+				auto const index = find(key);
+				if (index == _Keys.size())
+				{
+					return;
+				}
+
+				if (_NotifyDepth)
+				{
+					_Detached[index] = 1;
+					_DetachedCount++;
+					return;
+				}
+
+				previous = std::move(_EventHandlers[index]);
+				_Keys.erase(_Keys.begin() + index);
+				_EventHandlers.erase(_EventHandlers.begin() + index);
+				_Detached.erase(_Detached.begin() + index);
+			}
+			void notify(typename TEvent::PayloadType const& eventPayload)
+			{
+				NotifyScope notifyScope{ *this };
+
+				// notify 중에는 배열 크기가 바뀌지 않음
+				std::size_t const count = _EventHandlers.size();
+				for (std::size_t index = 0; index < count; index++)
+				{
+					if (!_Detached[index])
+					{
+						_EventHandlers[index](eventPayload);
+					}
+				}
+			}
+
+		private:
+			std::size_t find(Key const key) const
+			{
+				for (std::size_t index = 0; index < _Keys.size(); index++)
+				{
+					if (_Keys[index] == key && !_Detached[index])
+					{
+						return index;
+					}
+				}
+				return _Keys.size();
+			}
+			EventHandler<TEvent> attachNow(Key const key, EventHandler<TEvent> eventHandler)
+			{
+				auto const index = find(key);
+				if (index != _Keys.size())
+				{
+					std::swap(_EventHandlers[index], eventHandler);
+					return eventHandler;
+				}
+
+				_Keys.push_back(key);
+				_EventHandlers.push_back(std::move(eventHandler));
+				_Detached.push_back(0);
+				return nullptr;
+			}
+			bool hasPendingChanges() const
+			{
+				return _DetachedCount || !_PendingAttachments.empty();
+			}
+			void applyPendingChanges()
+			{
+				// 떼어낸 handler 의 소멸자가 다시 등록/해제할 수 있으므로 적용하는 동안에도 notify 중으로 취급하고,
+				// 배열 정리가 끝난 뒤 handler 를 소멸시킨 다음 다시 적용
+				while (hasPendingChanges())
+				{
+					std::vector<EventHandler<TEvent>> eventHandlers;
+
+					_NotifyDepth++;
+					std::size_t next = 0;
+					for (std::size_t index = 0; index < _Keys.size(); index++)
+					{
+						if (_Detached[index])
+						{
+							eventHandlers.push_back(std::move(_EventHandlers[index]));
+							continue;
+						}
+						if (next != index)
+						{
+							_Keys[next] = _Keys[index];
+							_EventHandlers[next] = std::move(_EventHandlers[index]);
+						}
+						next++;
+					}
+					_Keys.resize(next);
+					_EventHandlers.resize(next);
+					_Detached.assign(next, 0);
+					_DetachedCount = 0;
+
+					auto pendingAttachments = std::move(_PendingAttachments);
+					_PendingAttachments.clear();
+					for (auto& pendingAttachment : pendingAttachments)
+					{
+						eventHandlers.push_back(attachNow(pendingAttachment._Key, std::move(pendingAttachment._EventHandler)));
+					}
+
+					eventHandlers.clear();
+					_NotifyDepth--;
+				}
+			}
+		};
+
+	private:
+		std::tuple<EventHandlerList<TEvents>...> _EventHandlerLists;
+
+	public:
+		// 같은 Key 로 다시 등록하면 handler 를 교체
+		// handler 안에서 등록/해제해도 됨: 해제된 handler 는 그 notify 에서 더 호출되지 않고, 등록된 handler 는 다음 notify 부터 호출됨
+		template<typename TEvent, typename Handler>
+		void registerEventHandler(Key const key, Handler&& handler)
+		{
+			eventHandlerListOf<TEvent>().attach(key, EventHandler<TEvent>(std::forward<Handler>(handler)));
+		}
+		template<typename TEvent>
+		void unregisterEventHandler(Key const key)
+		{
+			eventHandlerListOf<TEvent>().detach(key);
+		}
+		void unregisterEventHandler(Key const key)
+		{
+			(unregisterEventHandler<TEvents>(key), ...);
+		}
+
+	public:
+		template<typename TEvent>
+		void notifyEvent(typename TEvent::PayloadType const& eventPayload)
+		{
+			eventHandlerListOf<TEvent>().notify(eventPayload);
+		}
+
+	private:
+		template<typename TEvent>
+		EventHandlerList<TEvent>& eventHandlerListOf()
+		{
+			static_assert(indexOf<TEvent> < sizeof...(TEvents), "TEvent is not part of this StaticEventDispatcher");
+			return std::get<indexOf<TEvent>>(_EventHandlerLists);
+		}
+	};
+}
+
+
+
+
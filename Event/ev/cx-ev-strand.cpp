@@ -0,0 +1,327 @@
+﻿/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+#include "pch.hpp"
+
+#include "cx-ev.hpp"
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	namespace
+	{
+		thread_local WorkStealingExecutor const* _CurrentExecutor{ nullptr };
+		thread_local std::size_t _CurrentWorkerIndex{ 0 };
+	}
+
+	WorkStealingExecutor::WorkStealingExecutor(std::size_t const workerCount)
+	{
+		std::size_t const count = workerCount ? workerCount : 1;
+
+		_WorkerQueues.reserve(count);
+		for (std::size_t i = 0; i < count; i++)
+		{
+			_WorkerQueues.push_back(std::make_unique<WorkerQueue>());
+		}
+
+		_Workers.reserve(count);
+		for (std::size_t i = 0; i < count; i++)
+		{
+			_Workers.emplace_back(&WorkStealingExecutor::run, this, i);
+		}
+	}
+	WorkStealingExecutor::~WorkStealingExecutor()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_Mutex);
+			_Stopped = true;
+		}
+		_Wakeup.notify_all();
+
+		for (auto& worker : _Workers)
+		{
+			worker.join();
+		}
+	}
+	void WorkStealingExecutor::submit(Task task)
+	{
+		std::size_t index;
+		if (_CurrentExecutor == this)
+		{
+			index = _CurrentWorkerIndex;
+		}
+		else
+		{
+			index = _NextWorkerQueue.fetch_add(1, std::memory_order_relaxed) % _WorkerQueues.size();
+		}
+
+		// 넣기 전에 세어 두어야 꺼낸 worker 의 fetch_sub 가 먼저 일어나도 0 아래로 내려가지 않음
+		_PendingCount.fetch_add(1, std::memory_order_seq_cst);
+		{
+			auto& workerQueue = *_WorkerQueues[index];
+			std::lock_guard<std::mutex> lock(workerQueue._Mutex);
+			workerQueue._Tasks.push_back(std::move(task));
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_Mutex);
+		}
+		_Wakeup.notify_one();
+	}
+	std::size_t WorkStealingExecutor::workerCount() const
+	{
+		return _Workers.size();
+	}
+	bool WorkStealingExecutor::tryPop(std::size_t const index, Task& task)
+	{
+		// 자기 deque 는 뒤에서 (최근 것부터)
+		{
+			auto& workerQueue = *_WorkerQueues[index];
+			std::lock_guard<std::mutex> lock(workerQueue._Mutex);
+			if (!workerQueue._Tasks.empty())
+			{
+				task = std::move(workerQueue._Tasks.back());
+				workerQueue._Tasks.pop_back();
+				return true;
+			}
+		}
+
+		// 다른 worker 의 deque 는 앞에서 (오래된 것부터) 훔쳐 옴
+		std::size_t const count = _WorkerQueues.size();
+		for (std::size_t i = 1; i < count; i++)
+		{
+			auto& workerQueue = *_WorkerQueues[(index + i) % count];
+			std::unique_lock<std::mutex> lock(workerQueue._Mutex, std::try_to_lock);
+			if (lock.owns_lock() && !workerQueue._Tasks.empty())
+			{
+				task = std::move(workerQueue._Tasks.front());
+				workerQueue._Tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+	void WorkStealingExecutor::run(std::size_t const index)
+	{
+		_CurrentExecutor = this;
+		_CurrentWorkerIndex = index;
+
+		Task task;
+		while (true)
+		{
+			if (tryPop(index, task))
+			{
+				_PendingCount.fetch_sub(1, std::memory_order_seq_cst);
+				task();
+				task = nullptr;
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(_Mutex);
+			if (_Stopped && _PendingCount.load() == 0)
+			{
+				break;
+			}
+			if (_PendingCount.load() != 0)
+			{
+				// 남은 task 가 아직 deque 에 들어가는 중이거나 다른 worker 가 그 deque 를 잡고 있음, 기다리면 깨울 사람이 없으므로 양보 후 다시 시도
+				lock.unlock();
+				std::this_thread::yield();
+				continue;
+			}
+			_Wakeup.wait(lock,
+				[this]()
+				{
+					return _Stopped || _PendingCount.load() != 0;
+				}
+			);
+		}
+
+		_CurrentExecutor = nullptr;
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	EventStrands::EventStrands(WorkStealingExecutor& executor, PostedEventHandler const& postedEventHandler) :
+		_Executor(executor),
+		_PostedEventHandler(postedEventHandler)
+	{
+	}
+	EventStrands::~EventStrands()
+	{
+		flush();
+	}
+	void EventStrands::post(PostedEvent&& postedEvent)
+	{
+		_Outstanding.fetch_add(1, std::memory_order_relaxed);
+
+		std::shared_ptr<Strand> strand;
+		bool schedule = false;
+		{
+			void const* eventTarget = postedEvent._EventTarget.get();
+			auto& strandShard = shardOf(eventTarget);
+			std::lock_guard<std::mutex> shardLock(strandShard._Mutex);
+
+			auto& entry = strandShard._Strands[eventTarget];
+			if (!entry)
+			{
+				entry = std::make_shared<Strand>();
+				entry->_EventTarget = eventTarget;
+			}
+			strand = entry;
+
+			std::lock_guard<std::mutex> strandLock(strand->_Mutex);
+			strand->_PostedEvents.push_back(std::move(postedEvent));
+			if (!strand->_Scheduled)
+			{
+				strand->_Scheduled = true;
+				schedule = true;
+			}
+		}
+
+		if (schedule)
+		{
+			this->schedule(std::move(strand));
+		}
+	}
+	void EventStrands::flush()
+	{
+		{
+			std::unique_lock<std::mutex> lock(_Mutex);
+			_Idle.wait(lock,
+				[this]()
+				{
+					return _Outstanding.load(std::memory_order_acquire) == 0;
+				}
+			);
+		}
+		pruneIdleStrands();
+	}
+	void EventStrands::pruneIdleStrands()
+	{
+		for (auto& strandShard : _StrandShards)
+		{
+			std::lock_guard<std::mutex> shardLock(strandShard._Mutex);
+			for (auto it = strandShard._Strands.begin(); it != strandShard._Strands.end(); )
+			{
+				bool idle;
+				{
+					std::lock_guard<std::mutex> strandLock(it->second->_Mutex);
+					idle = !it->second->_Scheduled && it->second->_PostedEvents.empty();
+				}
+				if (idle)
+				{
+					it = strandShard._Strands.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+	}
+	std::size_t EventStrands::strandCount()
+	{
+		std::size_t count = 0;
+		for (auto& strandShard : _StrandShards)
+		{
+			std::lock_guard<std::mutex> shardLock(strandShard._Mutex);
+			count += strandShard._Strands.size();
+		}
+		return count;
+	}
+	void EventStrands::run(std::shared_ptr<Strand> const& strand)
+	{
+		for (std::size_t processed = 0; processed < BatchSize; processed++)
+		{
+			PostedEvent postedEvent;
+			{
+				std::lock_guard<std::mutex> strandLock(strand->_Mutex);
+				if (strand->_PostedEvents.empty())
+				{
+					strand->_Scheduled = false;
+					return;
+				}
+				postedEvent = std::move(strand->_PostedEvents.front());
+				strand->_PostedEvents.pop_front();
+			}
+
+			_PostedEventHandler(postedEvent);
+
+			bool drained;
+			{
+				std::lock_guard<std::mutex> strandLock(strand->_Mutex);
+				drained = strand->_PostedEvents.empty();
+				if (drained)
+				{
+					strand->_Scheduled = false;
+				}
+			}
+			// 비었으면 바로 표에서 뺌, _Outstanding 을 줄이기 전에 해야 flush() 뒤 소멸된 EventStrands 를 건드리지 않음
+			if (drained)
+			{
+				pruneStrand(strand);
+			}
+
+			if (_Outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				std::lock_guard<std::mutex> lock(_Mutex);
+				_Idle.notify_all();
+			}
+			if (drained)
+			{
+				return;
+			}
+		}
+
+		// 다른 strand 에 차례를 넘기고 다시 예약, _Scheduled 를 유지하므로 순서는 보장됨
+		schedule(strand);
+	}
+	void EventStrands::pruneStrand(std::shared_ptr<Strand> const& strand)
+	{
+		auto& strandShard = shardOf(strand->_EventTarget);
+		std::lock_guard<std::mutex> shardLock(strandShard._Mutex);
+
+		// 그 사이 post 되었거나 같은 EventTarget 으로 새 strand 가 만들어졌으면 그대로 둠
+		auto it = strandShard._Strands.find(strand->_EventTarget);
+		if (it == strandShard._Strands.end() || it->second != strand)
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> strandLock(strand->_Mutex);
+		if (!strand->_Scheduled && strand->_PostedEvents.empty())
+		{
+			strandShard._Strands.erase(it);
+		}
+	}
+	void EventStrands::schedule(std::shared_ptr<Strand> strand)
+	{
+		_Executor.submit(
+			[this, strand = std::move(strand)]()
+			{
+				run(strand);
+			}
+		);
+	}
+	EventStrands::StrandShard& EventStrands::shardOf(void const* eventTarget)
+	{
+		auto const address = reinterpret_cast<std::uintptr_t>(eventTarget);
+		return _StrandShards[((address >> 4) ^ (address >> 12)) % ShardCount];
+	}
+}
+
+
+
+
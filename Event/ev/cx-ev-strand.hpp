@@ -0,0 +1,162 @@
+﻿#pragma once
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev
+{
+	// worker 마다 deque 를 두고, 자기 deque 가 비면 다른 worker 의 deque 에서 훔쳐 옴
+	class WorkStealingExecutor
+	{
+	public:
+		using Task = Delegate<void()>;
+
+	private:
+		struct alignas(64) WorkerQueue
+		{
+			std::mutex _Mutex;
+			std::deque<Task> _Tasks;
+		};
+
+	private:
+		std::vector<std::unique_ptr<WorkerQueue>> _WorkerQueues;
+		std::vector<std::thread> _Workers;
+
+		std::mutex _Mutex;
+		std::condition_variable _Wakeup;
+		std::atomic<std::size_t> _PendingCount{ 0 };
+		std::atomic<std::size_t> _NextWorkerQueue{ 0 };
+		bool _Stopped{ false };
+
+	public:
+		explicit WorkStealingExecutor(std::size_t const workerCount = std::thread::hardware_concurrency());
+
+	public:
+		~WorkStealingExecutor();
+
+	public:
+		WorkStealingExecutor(WorkStealingExecutor const&) = delete;
+		WorkStealingExecutor& operator=(WorkStealingExecutor const&) = delete;
+
+	public:
+		// worker thread 에서 호출하면 그 worker 의 deque 에, 아니면 round robin 으로 넣음
+		void submit(Task task);
+		std::size_t workerCount() const;
+
+	private:
+		bool tryPop(std::size_t const index, Task& task);
+		void run(std::size_t const index);
+	};
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	// EventTarget 별 직렬 strand
+	// - 같은 EventTarget 의 이벤트는 post 순서대로 하나씩 처리
+	// - 다른 EventTarget 의 strand 는 WorkStealingExecutor 에서 병렬로 처리
+	// - 처리할 이벤트가 없어진 strand 는 바로 표에서 빼므로 EventTarget 수만큼 쌓이지 않음
+	class EventStrands
+	{
+	public:
+		using PostedEventHandler = Delegate<void(PostedEvent&)>;
+		static constexpr std::size_t ShardCount = 16;
+		static constexpr std::size_t BatchSize = 64;
+
+	private:
+		struct Strand
+		{
+			void const* _EventTarget{ nullptr };
+			std::mutex _Mutex;
+			std::deque<PostedEvent> _PostedEvents;
+			bool _Scheduled{ false };
+		};
+
+		struct alignas(64) StrandShard
+		{
+			std::mutex _Mutex;
+			std::unordered_map<void const*, std::shared_ptr<Strand>> _Strands;
+		};
+
+	private:
+		WorkStealingExecutor& _Executor;
+		PostedEventHandler _PostedEventHandler;
+		std::array<StrandShard, ShardCount> _StrandShards;
+
+		std::mutex _Mutex;
+		std::condition_variable _Idle;
+		std::atomic<std::size_t> _Outstanding{ 0 };
+
+	public:
+		EventStrands(WorkStealingExecutor& executor, PostedEventHandler const& postedEventHandler);
+
+	public:
+		~EventStrands();
+
+	public:
+		EventStrands(EventStrands const&) = delete;
+		EventStrands& operator=(EventStrands const&) = delete;
+
+	public:
+		void post(PostedEvent&& postedEvent);
+		// 지금까지 post 된 이벤트가 모두 처리될 때까지 대기, worker thread 안에서 호출하면 안 됨
+		void flush();
+		void pruneIdleStrands();
+		// 표에 남아 있는 strand 수
+		std::size_t strandCount();
+
+	private:
+		void run(std::shared_ptr<Strand> const& strand);
+		void pruneStrand(std::shared_ptr<Strand> const& strand);
+		void schedule(std::shared_ptr<Strand> strand);
+		StrandShard& shardOf(void const* eventTarget);
+	};
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	// EventTarget 단위 순서 보장 비동기 dispatcher
+	// 여러 worker 가 동시에 호출하므로 기본값은 ConcurrentEventDispatcher
+	template<typename TEventDispatcher = ConcurrentEventDispatcher>
+	class StrandEventDispatcher
+	{
+	private:
+		EventStrands _EventStrands;
+
+	public:
+		StrandEventDispatcher(TEventDispatcher& eventDispatcher, WorkStealingExecutor& executor) :
+			_EventStrands(
+				executor,
+				[&eventDispatcher](PostedEvent& postedEvent)
+				{
+					eventDispatcher.notifyEvent(postedEvent._EventType, postedEvent._EventTarget, std::move(postedEvent._EventData));
+				}
+			)
+		{
+		}
+
+	public:
+		void postEvent(EventType const eventType, EventTarget const& eventTarget, std::shared_ptr<EventData> eventData)
+		{
+			_EventStrands.post(PostedEvent{ eventType, eventTarget, std::move(eventData) });
+		}
+		void flush()
+		{
+			_EventStrands.flush();
+		}
+	};
+}
+
+
+
+
@@ -12,45 +12,351 @@
 //===========================================================================
 namespace cx::ev::target
 {
+	Subscription::Subscription(std::weak_ptr<EventListener> eventListener, EventListener::Token const token) :
+		_EventListener(std::move(eventListener)),
+		_Token(token)
+	{
+	}
+	Subscription::Subscription(
+		std::weak_ptr<EventHandlerRegistry*> eventHandlerRegistry,
+		EventType const eventType,
+		WeakEventTarget eventTarget,
+		std::weak_ptr<EventListener> eventListener,
+		EventListener::Token const token
+	) :
+		_EventListener(std::move(eventListener)),
+		_EventHandlerRegistry(std::move(eventHandlerRegistry)),
+		_EventType(eventType),
+		_EventTarget(std::move(eventTarget)),
+		_Token(token)
+	{
+	}
+	Subscription::~Subscription()
+	{
+		reset();
+	}
+	Subscription::Subscription(Subscription&& other) noexcept :
+		_EventListener(std::move(other._EventListener)),
+		_EventHandlerRegistry(std::move(other._EventHandlerRegistry)),
+		_EventType(other._EventType),
+		_EventTarget(std::move(other._EventTarget)),
+		_Token(other._Token)
+	{
+		other.release();
+	}
+	Subscription& Subscription::operator=(Subscription&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			_EventListener = std::move(other._EventListener);
+			_EventHandlerRegistry = std::move(other._EventHandlerRegistry);
+			_EventType = other._EventType;
+			_EventTarget = std::move(other._EventTarget);
+			_Token = other._Token;
+			other.release();
+		}
+		return *this;
+	}
+	Subscription::operator bool() const
+	{
+		return !_EventListener.expired();
+	}
+	void Subscription::reset()
+	{
+		auto eventListener = _EventListener.lock();
+		auto eventHandlerRegistry = _EventHandlerRegistry.lock();
+		auto eventTarget = std::move(_EventTarget);
+		release();
+
+		if (!eventListener)
+		{
+			return;
+		}
+		if (eventHandlerRegistry)
+		{
+			(*eventHandlerRegistry)->unsubscribeEventHandler(_EventType, eventTarget, eventListener, _Token);
+			return;
+		}
+		eventListener->detach(_Token);
+	}
+	void Subscription::release()
+	{
+		_EventListener.reset();
+		_EventHandlerRegistry.reset();
+		_EventTarget.reset();
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	EventListener::NotifyScope::NotifyScope(EventListener& eventListener) :
+		_EventListener(eventListener)
+	{
+		_EventListener._NotifyDepth++;
+	}
+	EventListener::NotifyScope::~NotifyScope()
+	{
+		if (--_EventListener._NotifyDepth == 0)
+		{
+			_EventListener.applyPendingChanges();
+		}
+	}
 	EventListener::EventListener()
-		: _CurrentToken(0)
 	{
 	}
-	EventListener::Token EventListener::attach(EventHandler const& eventHandler)
+	EventListener::Token EventListener::attach(EventHandler const& eventHandler, EventHandlerPriority const priority)
+	{
+		if (!eventHandler)
+		{
+			return Token{};
+		}
+
+		std::uint32_t const slot = allocateSlot();
+		if (_NotifyDepth)
+		{
+			_Slots[slot]._Index = PendingIndexFlag | static_cast<std::uint32_t>(_PendingAttachments.size());
+			_PendingAttachments.push_back({ slot, priority, eventHandler });
+		}
+		else
+		{
+			insert(slot, eventHandler, priority);
+		}
+		return Token{ slot, _Slots[slot]._Generation };
+	}
+	Subscription EventListener::subscribe(EventHandler const& eventHandler, EventHandlerPriority const priority)
 	{
-		_CurrentToken++;
-		_EventHandlers[_CurrentToken] = eventHandler;
-		return _CurrentToken;
+		auto token = attach(eventHandler, priority);
+		return Subscription{ weak_from_this(), token };
 	}
 	void EventListener::detach(Token const token)
 	{
-		_EventHandlers.erase(token);
+		if (token.index >= _Slots.size() || _Slots[token.index]._Generation != token.generation)
+		{
+			return;
+		}
+
+		std::uint32_t const index = _Slots[token.index]._Index;
+		freeSlot(token.index);
+
+		if (index & PendingIndexFlag)
+		{
+			// 아직 붙지 않은 handler 는 실행 중일 수 없으므로 바로 지움 (소멸은 함수를 나갈 때)
+			EventHandler eventHandler = std::move(_PendingAttachments[index & ~PendingIndexFlag]._EventHandler);
+			return;
+		}
+
+		_Detached[index] = 1;
+		_DetachedCount++;
+
+		if (_NotifyDepth)
+		{
+			_PendingResets.push_back(index);
+			return;
+		}
+
+		// handler 소멸자가 이 EventListener 를 다시 detach 할 수 있으므로 배열 정리가 끝난 뒤 (함수를 나갈 때) 소멸
+		EventHandler eventHandler = std::move(_EventHandlers[index]);
+		if (_DetachedCount * 2 > _EventHandlers.size())
+		{
+			compact();
+		}
 	}
 	void EventListener::clear()
 	{
+		for (std::size_t i = 0; i < _EventHandlers.size(); i++)
+		{
+			if (!_Detached[i])
+			{
+				freeSlot(_SlotIndices[i]);
+			}
+		}
+		for (auto const& pendingAttachment : _PendingAttachments)
+		{
+			if (pendingAttachment._EventHandler)
+			{
+				freeSlot(pendingAttachment._Slot);
+			}
+		}
+
+		if (_NotifyDepth)
+		{
+			for (std::size_t i = 0; i < _EventHandlers.size(); i++)
+			{
+				if (!_Detached[i])
+				{
+					_Detached[i] = 1;
+					_DetachedCount++;
+					_PendingResets.push_back(i);
+				}
+			}
+			_PendingAttachments.clear();
+			return;
+		}
+
+		auto eventHandlers = std::move(_EventHandlers);
+		_SlotIndices.clear();
+		_Priorities.clear();
 		_EventHandlers.clear();
-		_CurrentToken = 0;
+		_Detached.clear();
+		_PendingAttachments.clear();
+		_DetachedCount = 0;
 	}
 	bool EventListener::empty() const
 	{
-		return _EventHandlers.empty();
+		if (_EventHandlers.size() != _DetachedCount)
+		{
+			return false;
+		}
+		return std::none_of(_PendingAttachments.begin(), _PendingAttachments.end(),
+			[](PendingAttachment const& pendingAttachment)
+			{
+				return static_cast<bool>(pendingAttachment._EventHandler);
+			}
+		);
 	}
 	void EventListener::notify(Event& event)
 	{
-		for (const auto& [token, eventHandler] : _EventHandlers)
+		NotifyScope notifyScope{ *this };
+
+		// notify 중에는 배열 크기와 위치가 바뀌지 않음
+		for (std::size_t i = 0; i < _EventHandlers.size(); i++)
 		{
-			eventHandler(event);
+			if (_Detached[i])
+			{
+				continue;
+			}
+			{
+				CX_EV_INSTRUMENT_HANDLER();
+				_EventHandlers[i](event);
+			}
 			if (event.handled())
 			{
 				break;
 			}
 		}
 	}
+	void EventListener::notify(std::span<Event> events)
+	{
+		for (auto& event : events)
+		{
+			notify(event);
+		}
+	}
 	void EventListener::notify(EventType const eventType, std::shared_ptr<EventData> eventData)
 	{
 		Event event{ eventType, eventData };
 		notify(event);
 	}
+	std::uint32_t EventListener::allocateSlot()
+	{
+		if (_FreeSlot != Token::InvalidIndex)
+		{
+			std::uint32_t const slot = _FreeSlot;
+			_FreeSlot = _Slots[slot]._Index;
+			return slot;
+		}
+
+		_Slots.push_back(Slot{ 0, 0 });
+		return static_cast<std::uint32_t>(_Slots.size() - 1);
+	}
+	void EventListener::freeSlot(std::uint32_t const slot)
+	{
+		_Slots[slot]._Generation++;
+		_Slots[slot]._Index = _FreeSlot;
+		_FreeSlot = slot;
+	}
+	void EventListener::insert(std::uint32_t const slot, EventHandler const& eventHandler, EventHandlerPriority const priority)
+	{
+		// 같은 priority 의 마지막 뒤에 삽입, 대부분은 끝에 붙이는 것으로 끝남
+		auto const position = std::partition_point(_Priorities.begin(), _Priorities.end(),
+			[priority](EventHandlerPriority const other)
+			{
+				return other >= priority;
+			}
+		);
+		std::size_t const index = static_cast<std::size_t>(position - _Priorities.begin());
+
+		_SlotIndices.insert(_SlotIndices.begin() + index, slot);
+		_Priorities.insert(position, priority);
+		_EventHandlers.insert(_EventHandlers.begin() + index, eventHandler);
+		_Detached.insert(_Detached.begin() + index, 0);
+		for (std::size_t i = index + 1; i < _EventHandlers.size(); i++)
+		{
+			if (!_Detached[i])
+			{
+				_Slots[_SlotIndices[i]]._Index = static_cast<std::uint32_t>(i);
+			}
+		}
+		_Slots[slot]._Index = static_cast<std::uint32_t>(index);
+	}
+	void EventListener::applyPendingChanges()
+	{
+		// detach 된 handler 의 소멸자가 이 EventListener 를 다시 attach/detach 할 수 있음
+		// 적용하는 동안에도 notify 중으로 취급해 그런 변경은 미뤄 두고, 배열 정리가 끝난 뒤 handler 를 소멸시킨 다음 다시 적용
+		while (!_PendingResets.empty() || !_PendingAttachments.empty())
+		{
+			std::vector<EventHandler> eventHandlers;
+
+			_NotifyDepth++;
+			for (auto const index : _PendingResets)
+			{
+				eventHandlers.push_back(std::move(_EventHandlers[index]));
+			}
+			_PendingResets.clear();
+
+			auto pendingAttachments = std::move(_PendingAttachments);
+			_PendingAttachments.clear();
+			for (auto& pendingAttachment : pendingAttachments)
+			{
+				if (pendingAttachment._EventHandler)
+				{
+					insert(pendingAttachment._Slot, pendingAttachment._EventHandler, pendingAttachment._Priority);
+				}
+			}
+
+			if (_DetachedCount * 2 > _EventHandlers.size())
+			{
+				compact();
+			}
+
+			eventHandlers.clear();
+			pendingAttachments.clear();
+			_NotifyDepth--;
+		}
+	}
+	void EventListener::compact()
+	{
+		// 빈 자리를 당겨 채움, 순서는 그대로
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < _EventHandlers.size(); i++)
+		{
+			if (_Detached[i])
+			{
+				continue;
+			}
+			if (count != i)
+			{
+				_SlotIndices[count] = _SlotIndices[i];
+				_Priorities[count] = _Priorities[i];
+				_EventHandlers[count] = std::move(_EventHandlers[i]);
+				_Detached[count] = 0;
+				_Slots[_SlotIndices[count]]._Index = static_cast<std::uint32_t>(count);
+			}
+			count++;
+		}
+		_SlotIndices.resize(count);
+		_Priorities.resize(count);
+		_EventHandlers.resize(count);
+		_Detached.resize(count);
+		_DetachedCount = 0;
+	}
 }
 
 
@@ -66,11 +372,11 @@ namespace cx::ev::target
 		_EventTarget(eventTarget)
 	{
 	}
-	EventType const EventId::eventType() const
+	EventType EventId::eventType() const
 	{
 		return _EventType;
 	}
-	EventTarget const EventId::eventTarget() const
+	EventTarget const& EventId::eventTarget() const
 	{
 		return _EventTarget;
 	}
@@ -84,40 +390,384 @@ namespace cx::ev::target
 //===========================================================================
 namespace cx::ev::target
 {
-	void EventDispatcher::registerEventListener(EventId const eventId, std::shared_ptr<EventListener> eventListener)
+	EventDispatcher::DispatchScope::DispatchScope(EventDispatcher& eventDispatcher) :
+		_EventDispatcher(eventDispatcher)
+	{
+		_EventDispatcher._DispatchDepth++;
+	}
+	EventDispatcher::DispatchScope::~DispatchScope()
+	{
+		if (--_EventDispatcher._DispatchDepth == 0 && !_EventDispatcher._RetiredEventListeners.empty())
+		{
+			auto retiredEventListeners = std::move(_EventDispatcher._RetiredEventListeners);
+			_EventDispatcher._RetiredEventListeners.clear();
+		}
+	}
+	void EventDispatcher::registerEventListener(EventId const& eventId, std::shared_ptr<EventListener> eventListener)
+	{
+		auto& entry = _EventListenerMap[EventKey{ eventId.eventType(), eventId.eventTarget().get() }];
+		entry._EventTarget = eventId.eventTarget();
+		retireEventListener(std::exchange(entry._EventListener, std::move(eventListener)));
+	}
+	void EventDispatcher::unregisterEventListener(EventId const& eventId)
 	{
-		_EventListenerMap[eventId] = eventListener;
+		eraseEventListener(EventKey{ eventId.eventType(), eventId.eventTarget().get() });
 	}
-	void EventDispatcher::unregisterEventListener(EventId const eventId)
+	std::shared_ptr<EventListener> EventDispatcher::getEventListener(EventId const& eventId)
 	{
-		_EventListenerMap.erase(eventId);
+		if (resolveEventListener(eventId.eventType(), eventId.eventTarget().get()))
+		{
+			return _EventListenerMap.find(EventKey{ eventId.eventType(), eventId.eventTarget().get() })->_EventListener;
+		}
+		return nullptr;
 	}
-	std::shared_ptr<EventListener> EventDispatcher::getEventListener(EventId const eventId)
+	EventListener* EventDispatcher::findEventListener(EventType const eventType, void const* eventTarget) const
 	{
-		auto it = _EventListenerMap.find(eventId);
-		if (it != _EventListenerMap.end())
+		auto entry = _EventListenerMap.find(EventKey{ eventType, eventTarget });
+		if (entry && !entry->_EventTarget.expired())
 		{
-			return it->second;
+			return entry->_EventListener.get();
 		}
 		return nullptr;
 	}
+	std::size_t EventDispatcher::sweep()
+	{
+		std::vector<EventKey> eventKeys;
+		_EventListenerMap.forEach(
+			[&eventKeys](EventKey const& eventKey, EventListenerEntry const& entry)
+			{
+				if (entry._EventTarget.expired())
+				{
+					eventKeys.push_back(eventKey);
+				}
+			}
+		);
+		for (auto const& eventKey : eventKeys)
+		{
+			eraseEventListener(eventKey);
+		}
+
+		std::vector<void const*> eventTargets;
+		_TargetPatternEntries.forEach(
+			[&eventTargets](void const* eventTarget, TargetPatternEntry const& targetPatternEntry)
+			{
+				if (targetPatternEntry._EventTarget.expired())
+				{
+					eventTargets.push_back(eventTarget);
+				}
+			}
+		);
+		for (auto const eventTarget : eventTargets)
+		{
+			eraseTargetPatternEntry(eventTarget);
+		}
+		return eventKeys.size() + eventTargets.size();
+	}
+	EventDispatcher::PatternToken EventDispatcher::registerPatternEventHandler(EventTypeRange const& eventTypes, EventTarget const& eventTarget, EventHandler const& eventHandler, EventHandlerPriority const priority)
+	{
+		if (!eventHandler || !eventTarget || eventTypes.begin >= eventTypes.end)
+		{
+			return PatternToken{};
+		}
+
+		auto targetPatternEntry = _TargetPatternEntries.find(eventTarget.get());
+		if (targetPatternEntry && targetPatternEntry->_EventTarget.expired())
+		{
+			// 같은 주소를 재사용한 이전 객체의 범위 구독은 버림
+			eraseTargetPatternEntry(eventTarget.get());
+			targetPatternEntry = nullptr;
+		}
+		if (!targetPatternEntry)
+		{
+			targetPatternEntry = &_TargetPatternEntries[eventTarget.get()];
+			targetPatternEntry->_EventTarget = eventTarget;
+		}
+
+		PatternToken const token = ++_CurrentPatternToken;
+		targetPatternEntry->_PatternEventHandlers.push_back({ token, eventTypes, priority, eventHandler });
+		rebuildPatternEventListeners(targetPatternEntry->_PatternEventHandlers, targetPatternEntry->_PatternEventListeners);
+		_PatternTokenTargets[token] = eventTarget.get();
+		return token;
+	}
+	EventDispatcher::PatternToken EventDispatcher::registerPatternEventHandler(EventTypeRange const& eventTypes, EventHandler const& eventHandler, EventHandlerPriority const priority)
+	{
+		if (!eventHandler || eventTypes.begin >= eventTypes.end)
+		{
+			return PatternToken{};
+		}
+
+		PatternToken const token = ++_CurrentPatternToken;
+		_PatternEventHandlers.push_back({ token, eventTypes, priority, eventHandler });
+		rebuildPatternEventListeners(_PatternEventHandlers, _PatternEventListeners);
+		_PatternTokenTargets[token] = nullptr;
+		return token;
+	}
+	void EventDispatcher::unregisterPatternEventHandler(PatternToken const token)
+	{
+		auto patternTokenTarget = _PatternTokenTargets.find(token);
+		if (!patternTokenTarget)
+		{
+			return;
+		}
+		void const* eventTarget = *patternTokenTarget;
+		_PatternTokenTargets.erase(token);
+
+		auto const erasePatternEventHandler =
+			[this, token](std::vector<PatternEventHandler>& patternEventHandlers, PatternEventListenerMap& patternEventListeners)
+			{
+				auto pattern = std::find_if(patternEventHandlers.begin(), patternEventHandlers.end(),
+					[token](PatternEventHandler const& patternEventHandler)
+					{
+						return patternEventHandler._Token == token;
+					}
+				);
+				if (pattern != patternEventHandlers.end())
+				{
+					patternEventHandlers.erase(pattern);
+					rebuildPatternEventListeners(patternEventHandlers, patternEventListeners);
+				}
+			};
+
+		if (!eventTarget)
+		{
+			erasePatternEventHandler(_PatternEventHandlers, _PatternEventListeners);
+			return;
+		}
+
+		auto targetPatternEntry = _TargetPatternEntries.find(eventTarget);
+		if (targetPatternEntry)
+		{
+			erasePatternEventHandler(targetPatternEntry->_PatternEventHandlers, targetPatternEntry->_PatternEventListeners);
+			if (targetPatternEntry->_PatternEventHandlers.empty())
+			{
+				eraseTargetPatternEntry(eventTarget);
+			}
+		}
+	}
+	void EventDispatcher::unregisterPatternEventHandlers(EventTarget const& eventTarget)
+	{
+		auto targetPatternEntry = _TargetPatternEntries.find(eventTarget.get());
+		if (targetPatternEntry && !targetPatternEntry->_EventTarget.expired())
+		{
+			eraseTargetPatternEntry(eventTarget.get());
+		}
+	}
+	EventListener* EventDispatcher::resolveEventListener(EventType const eventType, void const* eventTarget)
+	{
+		EventKey const eventKey{ eventType, eventTarget };
+
+		auto entry = _EventListenerMap.find(eventKey);
+		if (!entry)
+		{
+			return nullptr;
+		}
+		if (entry->_EventTarget.expired())
+		{
+			// 같은 주소에 새로 생긴 객체가 이전 객체의 등록을 물려받지 않도록 지움
+			eraseEventListener(eventKey);
+			return nullptr;
+		}
+		return entry->_EventListener.get();
+	}
+	void EventDispatcher::eraseEventListener(EventKey const& eventKey)
+	{
+		auto entry = _EventListenerMap.find(eventKey);
+		if (entry)
+		{
+			retireEventListener(std::move(entry->_EventListener));
+			_EventListenerMap.erase(eventKey);
+		}
+	}
+	void EventDispatcher::dispatchEventRun(EventType const eventType, void const* eventTarget, std::span<Event> events)
+	{
+		std::size_t eventListenerVersion = _EventListenerVersion;
+		auto eventListener = resolveEventListener(eventType, eventTarget);
+		for (auto& event : events)
+		{
+			// handler 가 EventListener 를 등록/해제했으면 남은 이벤트는 바뀐 EventListener 로 통지
+			if (eventListenerVersion != _EventListenerVersion)
+			{
+				eventListenerVersion = _EventListenerVersion;
+				eventListener = resolveEventListener(eventType, eventTarget);
+			}
+			if (eventListener)
+			{
+				eventListener->notify(event);
+			}
+			if (hasPatternEventHandlers())
+			{
+				dispatchPatternEvent(eventType, eventTarget, event);
+			}
+		}
+	}
+	bool EventDispatcher::hasPatternEventHandlers() const
+	{
+		return !_PatternEventHandlers.empty() || !_TargetPatternEntries.empty();
+	}
+	void EventDispatcher::dispatchPatternEvent(EventType const eventType, void const* eventTarget, Event& event)
+	{
+		if (event.handled())
+		{
+			return;
+		}
+
+		if (auto targetPatternEntry = _TargetPatternEntries.find(eventTarget))
+		{
+			if (targetPatternEntry->_EventTarget.expired())
+			{
+				eraseTargetPatternEntry(eventTarget);
+			}
+			else
+			{
+				auto eventListener = targetPatternEntry->_PatternEventListeners.find(eventType);
+				if (eventListener)
+				{
+					eventListener->notify(event);
+					if (event.handled())
+					{
+						return;
+					}
+				}
+			}
+		}
+
+		if (!_PatternEventHandlers.empty())
+		{
+			auto eventListener = _PatternEventListeners.find(eventType);
+			if (eventListener)
+			{
+				eventListener->notify(event);
+			}
+		}
+	}
+	void EventDispatcher::rebuildPatternEventListeners(std::vector<PatternEventHandler> const& patternEventHandlers, PatternEventListenerMap& patternEventListeners)
+	{
+		patternEventListeners.rebuild(patternEventHandlers,
+			[](EventListener& eventListener, PatternEventHandler const& patternEventHandler)
+			{
+				eventListener.attach(patternEventHandler._EventHandler, patternEventHandler._Priority);
+			},
+			[this](std::shared_ptr<EventListener> eventListener)
+			{
+				retireEventListener(std::move(eventListener));
+			}
+		);
+	}
+	void EventDispatcher::eraseTargetPatternEntry(void const* eventTarget)
+	{
+		auto targetPatternEntry = _TargetPatternEntries.find(eventTarget);
+		if (!targetPatternEntry)
+		{
+			return;
+		}
+
+		for (auto const& patternEventHandler : targetPatternEntry->_PatternEventHandlers)
+		{
+			_PatternTokenTargets.erase(patternEventHandler._Token);
+		}
+		targetPatternEntry->_PatternEventListeners.clear(
+			[this](std::shared_ptr<EventListener> eventListener)
+			{
+				retireEventListener(std::move(eventListener));
+			}
+		);
+		_TargetPatternEntries.erase(eventTarget);
+	}
+	void EventDispatcher::retireEventListener(std::shared_ptr<EventListener> eventListener)
+	{
+		// EventListener 를 바꾸거나 지우는 곳은 모두 여기를 거침
+		_EventListenerVersion++;
+
+		// notify 중인 EventListener 가 소멸되지 않도록 가장 바깥 dispatch 가 끝날 때까지 보관
+		if (_DispatchDepth && eventListener)
+		{
+			_RetiredEventListeners.push_back(std::move(eventListener));
+		}
+	}
 	void EventDispatcher::dispatchEvent(EventId const& eventId, Event& event)
 	{
-		auto eventListener = getEventListener(eventId);
+		dispatchEvent(eventId.eventType(), eventId.eventTarget().get(), event);
+	}
+	void EventDispatcher::dispatchEvent(EventType const eventType, void const* eventTarget, Event& event)
+	{
+		CX_EV_INSTRUMENT_DISPATCH(eventType, eventTarget, 1);
+		DispatchScope dispatchScope{ *this };
+
+		auto eventListener = resolveEventListener(eventType, eventTarget);
 		if (eventListener)
 		{
 			eventListener->notify(event);
 		}
+		if (hasPatternEventHandlers())
+		{
+			dispatchPatternEvent(eventType, eventTarget, event);
+		}
+	}
+	void EventDispatcher::dispatchEvents(std::span<EventTarget const> eventTargets, std::span<Event> events)
+	{
+		assert(eventTargets.size() == events.size());
+
+		DispatchScope dispatchScope{ *this };
+
+		std::size_t const count = events.size();
+
+		std::size_t begin = 0;
+		while (begin < count)
+		{
+			EventType const eventType = events[begin].eventType();
+			void const* eventTarget = eventTargets[begin].get();
+
+			std::size_t end = begin + 1;
+			while (end < count && events[end].eventType() == eventType && eventTargets[end].get() == eventTarget)
+			{
+				end++;
+			}
+
+			{
+				CX_EV_INSTRUMENT_DISPATCH(eventType, eventTarget, end - begin);
+				dispatchEventRun(eventType, eventTarget, events.subspan(begin, end - begin));
+			}
+			begin = end;
+		}
 	}
 	void EventDispatcher::notifyEvent(EventId const& eventId, Event& event)
 	{
 		dispatchEvent(eventId, event);
 	}
-	void EventDispatcher::notifyEvent(EventType const eventType, EventTarget const eventTarget, std::shared_ptr<EventData> eventData)
+	void EventDispatcher::notifyEvent(EventType const eventType, EventTarget const& eventTarget, Event& event)
+	{
+		dispatchEvent(eventType, eventTarget.get(), event);
+	}
+	void EventDispatcher::notifyEvent(EventType const eventType, EventTarget const& eventTarget, std::shared_ptr<EventData> eventData)
 	{
-		EventId eventId{ eventType, eventTarget };
 		Event event{ eventType, eventData };
-		notifyEvent(eventId, event);
+		notifyEvent(eventType, eventTarget, event);
+	}
+	void EventDispatcher::notifyEvents(std::span<EventTarget const> eventTargets, std::span<Event> events)
+	{
+		dispatchEvents(eventTargets, events);
+	}
+	void EventDispatcher::notifyEvents(EventTarget const& eventTarget, std::span<Event> events)
+	{
+		DispatchScope dispatchScope{ *this };
+
+		std::size_t begin = 0;
+		while (begin < events.size())
+		{
+			EventType const eventType = events[begin].eventType();
+
+			std::size_t end = begin + 1;
+			while (end < events.size() && events[end].eventType() == eventType)
+			{
+				end++;
+			}
+
+			{
+				CX_EV_INSTRUMENT_DISPATCH(eventType, eventTarget.get(), end - begin);
+				dispatchEventRun(eventType, eventTarget.get(), events.subspan(begin, end - begin));
+			}
+			begin = end;
+		}
 	}
 }
 
@@ -136,49 +786,230 @@ namespace cx::ev::target
 	void EventHandlerRegistry::registerEventHandler(
 		EventType const eventType,
 		EventTarget const& eventTarget,
-		EventHandler const& eventHandler
+		EventHandler const& eventHandler,
+		EventHandlerPriority const priority
+	)
+	{
+		std::shared_ptr<EventListener> eventListener;
+		attachEventHandler(eventType, eventTarget, eventHandler, priority, eventListener);
+	}
+	Subscription EventHandlerRegistry::subscribeEventHandler(
+		EventType const eventType,
+		EventTarget const& eventTarget,
+		EventHandler const& eventHandler,
+		EventHandlerPriority const priority
+	)
+	{
+		std::shared_ptr<EventListener> eventListener;
+		auto token = attachEventHandler(eventType, eventTarget, eventHandler, priority, eventListener);
+		if (token.index == EventListener::Token::InvalidIndex)
+		{
+			return Subscription{};
+		}
+		return Subscription{ _Self, eventType, eventTarget, eventListener, token };
+	}
+	void EventHandlerRegistry::unsubscribeEventHandler(EventType const eventType, WeakEventTarget const& eventTarget, std::shared_ptr<EventListener> const& eventListener, EventListener::Token const token)
+	{
+		eventListener->detach(token);
+
+		// 이미 소멸된 EventTarget 의 기록은 sweep() 이 지움 (같은 주소를 재사용한 객체의 기록일 수 있음)
+		auto const lockedEventTarget = eventTarget.lock();
+		if (!lockedEventTarget)
+		{
+			return;
+		}
+
+		auto eventTargetEntry = _EventTargetEntries.find(lockedEventTarget.get());
+		if (eventTargetEntry && !eventTargetEntry->_EventTarget.expired())
+		{
+			std::erase_if(eventTargetEntry->_EventTypeTokens,
+				[eventType, token](std::pair<EventType, EventListener::Token> const& eventTypeToken)
+				{
+					return eventTypeToken.first == eventType
+						&& eventTypeToken.second.index == token.index
+						&& eventTypeToken.second.generation == token.generation;
+				}
+			);
+			if (eventTargetEntry->_EventTypeTokens.empty() && eventTargetEntry->_PatternTokens.empty())
+			{
+				_EventTargetEntries.erase(lockedEventTarget.get());
+			}
+		}
+
+		// 구독 뒤 registerEventListener 로 EventListener 가 바뀌었으면 지금 EventListener 는 건드리지 않음
+		if (eventListener->empty() && _EventDispatcher.findEventListener(eventType, lockedEventTarget.get()) == eventListener.get())
+		{
+			_EventDispatcher.unregisterEventListener(EventId{ eventType, lockedEventTarget });
+		}
+	}
+	void EventHandlerRegistry::registerEventHandler(
+		EventTypeRange const& eventTypes,
+		EventTarget const& eventTarget,
+		EventHandler const& eventHandler,
+		EventHandlerPriority const priority
+	)
+	{
+		auto const token = _EventDispatcher.registerPatternEventHandler(eventTypes, eventTarget, eventHandler, priority);
+		if (token == EventDispatcher::PatternToken{})
+		{
+			return;
+		}
+
+		eventTargetEntryOf(eventTarget)._PatternTokens.push_back(token);
+		_PatternTokenTargets[token] = eventTarget.get();
+	}
+	EventDispatcher::PatternToken EventHandlerRegistry::registerEventHandler(
+		EventTypeRange const& eventTypes,
+		EventHandler const& eventHandler,
+		EventHandlerPriority const priority
+	)
+	{
+		return _EventDispatcher.registerPatternEventHandler(eventTypes, eventHandler, priority);
+	}
+	EventListener::Token EventHandlerRegistry::attachEventHandler(
+		EventType const eventType,
+		EventTarget const& eventTarget,
+		EventHandler const& eventHandler,
+		EventHandlerPriority const priority,
+		std::shared_ptr<EventListener>& eventListener
 	)
 	{
 		EventId eventId{ eventType, eventTarget };
 
-		auto eventListener = _EventDispatcher.getEventListener(eventId);
+		eventListener = _EventDispatcher.getEventListener(eventId);
 		if (!eventListener)
 		{
-			eventListener = std::make_shared<EventListener>();
+			eventListener = std::allocate_shared<EventListener>(PoolAllocator<EventListener>{});
 			_EventDispatcher.registerEventListener(eventId, eventListener);
 		}
 
-		auto token = eventListener->attach(eventHandler);
-		_EventIdTokens.push_back({ eventId, token });
+		auto token = eventListener->attach(eventHandler, priority);
+		eventTargetEntryOf(eventTarget)._EventTypeTokens.push_back({ eventType, token });
+		return token;
+	}
+	EventHandlerRegistry::EventTargetEntry& EventHandlerRegistry::eventTargetEntryOf(EventTarget const& eventTarget)
+	{
+		auto eventTargetEntry = _EventTargetEntries.find(eventTarget.get());
+		if (eventTargetEntry && eventTargetEntry->_EventTarget.expired())
+		{
+			// 같은 주소를 재사용한 이전 객체의 등록 정보는 버림
+			eraseEventTargetEntry(eventTarget.get());
+			eventTargetEntry = nullptr;
+		}
+		if (eventTargetEntry)
+		{
+			return *eventTargetEntry;
+		}
+
+		// EventTarget 수가 지난 sweep 의 두 배가 되면 만료된 항목을 정리하여 메모리를 제한
+		if (_EventTargetEntries.size() + 1 >= _SweepThreshold)
+		{
+			sweep();
+			_SweepThreshold = std::max<std::size_t>(64, (_EventTargetEntries.size() + 1) * 2);
+		}
+
+		auto& entry = _EventTargetEntries[eventTarget.get()];
+		entry._EventTarget = eventTarget;
+		return entry;
+	}
+	void EventHandlerRegistry::eraseEventTargetEntry(void const* eventTarget)
+	{
+		auto eventTargetEntry = _EventTargetEntries.find(eventTarget);
+		if (!eventTargetEntry)
+		{
+			return;
+		}
+
+		for (auto const token : eventTargetEntry->_PatternTokens)
+		{
+			_PatternTokenTargets.erase(token);
+		}
+		_EventTargetEntries.erase(eventTarget);
 	}
 	void EventHandlerRegistry::unregisterEventHandler(EventTarget const& eventTarget)
 	{
-		std::vector<std::pair<EventId, EventListener::Token>> eventIdTokens;
-		for (auto& [eventId, token] : _EventIdTokens)
+		auto eventTargetEntry = _EventTargetEntries.find(eventTarget.get());
+		if (!eventTargetEntry)
+		{
+			return;
+		}
+
+		// 만료된 항목은 같은 주소를 재사용한 다른 객체의 것이므로 해제하지 않음
+		// 다른 EventHandlerRegistry 나 EventDispatcher 에 직접 등록한 범위 구독은 건드리지 않음
+		if (!eventTargetEntry->_EventTarget.expired())
 		{
-			if (eventId.eventTarget() == eventTarget)
+			for (auto const& [eventType, token] : eventTargetEntry->_EventTypeTokens)
 			{
-				auto eventListener = _EventDispatcher.getEventListener(eventId);
+				auto eventListener = _EventDispatcher.findEventListener(eventType, eventTarget.get());
 				if (eventListener)
 				{
 					eventListener->detach(token);
 					if (eventListener->empty())
 					{
-						_EventDispatcher.unregisterEventListener(eventId);
+						_EventDispatcher.unregisterEventListener(EventId{ eventType, eventTarget });
 					}
 				}
-				eventIdTokens.push_back({ eventId, token });
 			}
+			for (auto const token : eventTargetEntry->_PatternTokens)
+			{
+				_EventDispatcher.unregisterPatternEventHandler(token);
+			}
+		}
+		eraseEventTargetEntry(eventTarget.get());
+	}
+	void EventHandlerRegistry::unregisterEventHandler(EventDispatcher::PatternToken const token)
+	{
+		_EventDispatcher.unregisterPatternEventHandler(token);
+
+		auto patternTokenTarget = _PatternTokenTargets.find(token);
+		if (!patternTokenTarget)
+		{
+			return;
 		}
-		for (const auto& eventIdToken : eventIdTokens)
+		void const* eventTarget = *patternTokenTarget;
+		_PatternTokenTargets.erase(token);
+
+		auto eventTargetEntry = _EventTargetEntries.find(eventTarget);
+		if (eventTargetEntry)
 		{
-			auto it = std::find(_EventIdTokens.begin(), _EventIdTokens.end(), eventIdToken);
-			if (it != _EventIdTokens.end())
+			std::erase(eventTargetEntry->_PatternTokens, token);
+			if (eventTargetEntry->_EventTypeTokens.empty() && eventTargetEntry->_PatternTokens.empty())
 			{
-				_EventIdTokens.erase(it);
+				_EventTargetEntries.erase(eventTarget);
 			}
 		}
 	}
+	void EventHandlerRegistry::unregisterEventHandlers(std::span<EventTarget const> eventTargets)
+	{
+		for (auto const& eventTarget : eventTargets)
+		{
+			unregisterEventHandler(eventTarget);
+		}
+	}
+	std::size_t EventHandlerRegistry::sweep()
+	{
+		std::vector<void const*> eventTargets;
+		_EventTargetEntries.forEach(
+			[&eventTargets](void const* eventTarget, EventTargetEntry const& eventTargetEntry)
+			{
+				if (eventTargetEntry._EventTarget.expired())
+				{
+					eventTargets.push_back(eventTarget);
+				}
+			}
+		);
+		for (auto const eventTarget : eventTargets)
+		{
+			eraseEventTargetEntry(eventTarget);
+		}
+
+		_EventDispatcher.sweep();
+		return eventTargets.size();
+	}
+	std::size_t EventHandlerRegistry::eventTargetCount() const
+	{
+		return _EventTargetEntries.size();
+	}
 }
 
 
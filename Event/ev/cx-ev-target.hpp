@@ -4,21 +4,93 @@
 //===========================================================================
 namespace cx::ev::target
 {
-	class EventListener
+	using EventTarget = std::shared_ptr<void>;
+	using WeakEventTarget = std::weak_ptr<void>;
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	class Subscription;
+	class EventHandlerRegistry;
+
+	class EventListener : public std::enable_shared_from_this<EventListener>
 	{
 	public:
-		using Token = std::uint32_t;
+		// generational slot map 의 (slot 번호, 세대)
+		// detach 되거나 clear() 된 slot 은 세대가 바뀌므로 이전 Token 으로는 새 handler 를 detach 할 수 없음
+		struct Token
+		{
+			static constexpr std::uint32_t InvalidIndex = 0xffffffffu;
+
+			std::uint32_t index{ InvalidIndex };
+			std::uint32_t generation{ 0 };
+		};
 
 	private:
-		Token _CurrentToken;
-		std::unordered_map<Token, EventHandler> _EventHandlers;
+		struct Slot
+		{
+			std::uint32_t _Index;      // 사용 중: _EventHandlers 위치 (PendingIndexFlag: _PendingAttachments 위치), 비어 있음: 다음 빈 slot
+			std::uint32_t _Generation;
+		};
+		static constexpr std::uint32_t PendingIndexFlag = 0x80000000u;
+
+		struct PendingAttachment
+		{
+			std::uint32_t _Slot;
+			EventHandlerPriority _Priority;
+			EventHandler _EventHandler;
+		};
+
+		// notify 중첩 깊이를 세고, 가장 바깥 notify 가 끝날 때 미뤄둔 변경을 적용
+		class NotifyScope
+		{
+		private:
+			EventListener& _EventListener;
+
+		public:
+			explicit NotifyScope(EventListener& eventListener);
+
+		public:
+			~NotifyScope();
+
+		public:
+			NotifyScope(NotifyScope const&) = delete;
+			NotifyScope& operator=(NotifyScope const&) = delete;
+		};
+
+	private:
+		std::vector<Slot> _Slots;
+		std::uint32_t _FreeSlot{ Token::InvalidIndex };
+		// priority 내림차순으로 정렬된 조밀한 배열, 정렬은 attach 에서만 함
+		// detach 된 자리는 _Detached 로 표시해 순서를 유지하고, 빈 자리가 절반을 넘으면 compact()
+		std::vector<std::uint32_t> _SlotIndices;
+		std::vector<EventHandlerPriority> _Priorities;
+		std::vector<EventHandler> _EventHandlers;
+		std::vector<std::uint8_t> _Detached;
+		std::size_t _DetachedCount{ 0 };
+
+		// notify 중(handler 안)의 attach/detach/clear 는 배열을 옮기지 않음
+		// - detach: 표시만 하고 handler 소멸은 _PendingResets 로 미룸 (실행 중인 handler 를 지우지 않도록)
+		// - attach: Token 은 바로 발급하고 handler 는 _PendingAttachments 에 모았다가 가장 바깥 notify 가 끝날 때 붙임
+		std::size_t _NotifyDepth{ 0 };
+		std::vector<PendingAttachment> _PendingAttachments;
+		std::vector<std::size_t> _PendingResets;
 
 	public:
 		EventListener();
 
 	public:
-		Token attach(EventHandler const& eventHandler);
+		// 빈 eventHandler 는 붙이지 않고 무효 Token 을 반환
+		Token attach(EventHandler const& eventHandler, EventHandlerPriority const priority = 0);
 		void detach(Token const token);
+		// shared_ptr 로 소유된 EventListener 에서만 사용 가능
+		[[nodiscard]] Subscription subscribe(EventHandler const& eventHandler, EventHandlerPriority const priority = 0);
 
 	public:
 		void clear();
@@ -26,8 +98,24 @@ namespace cx::ev::target
 
 	public:
 		void notify(Event& event);
+		void notify(std::span<Event> events);
 		void notify(EventType const eventType, std::shared_ptr<EventData> eventData);
+		template<typename TEvent> void notify(typename TEvent::PayloadType const& eventPayload);
+
+	private:
+		std::uint32_t allocateSlot();
+		void freeSlot(std::uint32_t const slot);
+		void insert(std::uint32_t const slot, EventHandler const& eventHandler, EventHandlerPriority const priority);
+		void applyPendingChanges();
+		void compact();
 	};
+
+	template<typename TEvent>
+	void EventListener::notify(typename TEvent::PayloadType const& eventPayload)
+	{
+		Event event{ TEvent::eventType, &eventPayload };
+		notify(event);
+	}
 }
 
 
@@ -38,7 +126,44 @@ namespace cx::ev::target
 //===========================================================================
 namespace cx::ev::target
 {
-	using EventTarget = std::shared_ptr<void>;
+	// EventListener 에 붙인 Token 의 수명을 범위에 묶는 handle
+	// 이동만 가능, 소멸 시 detach. EventListener 가 먼저 사라졌거나 이미 detach 된 경우 아무것도 하지 않음
+	// EventHandlerRegistry 를 통해 구독했으면 EventHandlerRegistry 의 기록 (EventTarget 별 Token, 빈 EventListener) 도 함께 정리
+	// EventTarget 은 weak 로 보관: Subscription 이 객체 수명을 늘리지 않음
+	class Subscription
+	{
+	private:
+		std::weak_ptr<EventListener> _EventListener;
+		std::weak_ptr<EventHandlerRegistry*> _EventHandlerRegistry;
+		EventType _EventType{};
+		WeakEventTarget _EventTarget;
+		EventListener::Token _Token{};
+
+	public:
+		Subscription() = default;
+		Subscription(std::weak_ptr<EventListener> eventListener, EventListener::Token const token);
+		Subscription(
+			std::weak_ptr<EventHandlerRegistry*> eventHandlerRegistry,
+			EventType const eventType,
+			WeakEventTarget eventTarget,
+			std::weak_ptr<EventListener> eventListener,
+			EventListener::Token const token
+		);
+
+	public:
+		~Subscription();
+
+	public:
+		Subscription(Subscription const&) = delete;
+		Subscription& operator=(Subscription const&) = delete;
+		Subscription(Subscription&& other) noexcept;
+		Subscription& operator=(Subscription&& other) noexcept;
+
+	public:
+		explicit operator bool() const;
+		void reset();
+		void release();
+	};
 }
 
 
@@ -59,8 +184,39 @@ namespace cx::ev::target
 		EventId(EventType const eventType, EventTarget const& eventTarget);
 
 	public:
-		EventType const eventType() const;
-		EventTarget const eventTarget() const;
+		EventType eventType() const;
+		EventTarget const& eventTarget() const;
+	};
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace cx::ev::target
+{
+	// EventId 의 참조 계수 없는 조회용 키: (EventType, EventTarget 원시 포인터)
+	struct EventKey
+	{
+		EventType eventType;
+		void const* eventTarget;
+	};
+
+	inline bool operator==(EventKey const& lhs, EventKey const& rhs)
+	{
+		return (lhs.eventType == rhs.eventType && lhs.eventTarget == rhs.eventTarget);
+	}
+
+	struct EventKeyHash
+	{
+		std::size_t operator()(EventKey const& eventKey) const
+		{
+			auto const eventTarget = reinterpret_cast<std::uintptr_t>(eventKey.eventTarget);
+			auto const eventType = static_cast<std::uint32_t>(eventKey.eventType);
+			return std::hash<std::uint64_t>{}(static_cast<std::uint64_t>(eventTarget) ^ (static_cast<std::uint64_t>(eventType) * 0x9e3779b97f4a7c15ULL));
+		}
 	};
 }
 
@@ -105,20 +261,125 @@ namespace cx::ev::target
 	class EventDispatcher
 	{
 	private:
-		std::map<EventId, std::shared_ptr<EventListener>> _EventListenerMap;
+		// 부모 EventTarget 으로 전파할 때 원시 포인터로 바로 dispatch
+		friend class EventPropagator;
+
+	public:
+		using PatternToken = std::uint64_t;
+
+	private:
+		struct PatternEventHandler
+		{
+			PatternToken _Token;
+			EventTypeRange _EventTypes;
+			EventHandlerPriority _Priority;
+			EventHandler _EventHandler;
+		};
+		// 범위 구독이 바뀔 때 EventType 구간별로 다시 만드는 EventListener 표
+		using PatternEventListenerMap = PatternEventListenerTable<EventListener>;
+
+		// 특정 EventTarget 의 범위 구독
+		struct TargetPatternEntry
+		{
+			WeakEventTarget _EventTarget;
+			std::vector<PatternEventHandler> _PatternEventHandlers;
+			PatternEventListenerMap _PatternEventListeners;
+		};
+
+	private:
+		// EventTarget 은 weak 로 보관: 등록만으로 객체 수명을 늘리지 않음
+		// 만료된 항목은 dispatch 중에 발견되면 지우거나 sweep() 으로 한꺼번에 지움
+		struct EventListenerEntry
+		{
+			WeakEventTarget _EventTarget;
+			std::shared_ptr<EventListener> _EventListener;
+		};
+
+		// dispatch 중첩 깊이를 세고, 가장 바깥 dispatch 가 끝날 때 _RetiredEventListeners 를 비움
+		class DispatchScope
+		{
+		private:
+			EventDispatcher& _EventDispatcher;
+
+		public:
+			explicit DispatchScope(EventDispatcher& eventDispatcher);
+
+		public:
+			~DispatchScope();
+
+		public:
+			DispatchScope(DispatchScope const&) = delete;
+			DispatchScope& operator=(DispatchScope const&) = delete;
+		};
+
+	private:
+		FlatHashMap<EventKey, EventListenerEntry, EventKeyHash> _EventListenerMap;
+
+		// 범위 구독: 모든 EventTarget 대상과 EventTarget 별 대상으로 나누어 보관
+		// 구독이 바뀌면 해당 PatternEventListenerMap 만 다시 만듦. 범위 구독이 없으면 dispatch 비용 없음
+		std::vector<PatternEventHandler> _PatternEventHandlers;
+		PatternEventListenerMap _PatternEventListeners;
+		FlatHashMap<void const*, TargetPatternEntry> _TargetPatternEntries;
+		// PatternToken 으로 등록한 EventTarget 을 찾음, 모든 EventTarget 대상이면 nullptr
+		FlatHashMap<PatternToken, void const*> _PatternTokenTargets;
+		PatternToken _CurrentPatternToken{ 0 };
+
+		// dispatch 중에 해제된 EventListener 는 notify 가 끝날 때까지 여기서 살려둠
+		std::size_t _DispatchDepth{ 0 };
+		std::vector<std::shared_ptr<EventListener>> _RetiredEventListeners;
+		// EventListener 가 등록/해제될 때마다 증가, notifyEvents 는 이 값이 바뀌었을 때만 EventListener 를 다시 찾음
+		std::size_t _EventListenerVersion{ 0 };
+
+	public:
+		void registerEventListener(EventId const& eventId, std::shared_ptr<EventListener> eventListener);
+		void unregisterEventListener(EventId const& eventId);
+		std::shared_ptr<EventListener> getEventListener(EventId const& eventId);
+		EventListener* findEventListener(EventType const eventType, void const* eventTarget) const;
+		std::size_t sweep();
 
 	public:
-		void registerEventListener(EventId const eventId, std::shared_ptr<EventListener> eventListener);
-		void unregisterEventListener(EventId const eventId);
-		std::shared_ptr<EventListener> getEventListener(EventId const eventId);
+		// eventTarget 에 통지되는 eventTypes 범위의 모든 Event 를 받음, EventTypeRange::all() 은 모든 EventType
+		// 정확한 (EventType, EventTarget) 으로 등록한 handler, eventTarget 의 범위 구독, 모든 EventTarget 대상 범위 구독 순으로 호출됨
+		PatternToken registerPatternEventHandler(EventTypeRange const& eventTypes, EventTarget const& eventTarget, EventHandler const& eventHandler, EventHandlerPriority const priority = 0);
+		// 모든 EventTarget 에 통지되는 eventTypes 범위의 Event 를 받음
+		PatternToken registerPatternEventHandler(EventTypeRange const& eventTypes, EventHandler const& eventHandler, EventHandlerPriority const priority = 0);
+		void unregisterPatternEventHandler(PatternToken const token);
+		void unregisterPatternEventHandlers(EventTarget const& eventTarget);
 
 	protected:
 		void dispatchEvent(EventId const& eventId, Event& event);
+		void dispatchEvent(EventType const eventType, void const* eventTarget, Event& event);
+		void dispatchEvents(std::span<EventTarget const> eventTargets, std::span<Event> events);
 
 	public:
 		void notifyEvent(EventId const& eventId, Event& event);
-		void notifyEvent(EventType const eventType, EventTarget const eventTarget, std::shared_ptr<EventData> eventData);
+		void notifyEvent(EventType const eventType, EventTarget const& eventTarget, Event& event);
+		void notifyEvent(EventType const eventType, EventTarget const& eventTarget, std::shared_ptr<EventData> eventData);
+		template<typename TEvent> void notifyEvent(EventTarget const& eventTarget, typename TEvent::PayloadType const& eventPayload);
+		// events[i] 를 eventTargets[i] 에 통지, eventTargets 와 events 의 크기는 같아야 함
+		// 차례로 notifyEvent 한 것과 같은 순서로 통지 (이벤트마다 정확한 handler, 이어서 범위 구독 handler)
+		// 같은 (EventType, EventTarget) 이 연속된 구간마다 EventListener 를 한 번만 찾고, handler 가 등록을 바꿨을 때만 다시 찾음
+		void notifyEvents(std::span<EventTarget const> eventTargets, std::span<Event> events);
+		void notifyEvents(EventTarget const& eventTarget, std::span<Event> events);
+
+	private:
+		EventListener* resolveEventListener(EventType const eventType, void const* eventTarget);
+		void eraseEventListener(EventKey const& eventKey);
+		// 같은 (EventType, EventTarget) 인 events 를 차례로 통지
+		void dispatchEventRun(EventType const eventType, void const* eventTarget, std::span<Event> events);
+		bool hasPatternEventHandlers() const;
+		void dispatchPatternEvent(EventType const eventType, void const* eventTarget, Event& event);
+		void rebuildPatternEventListeners(std::vector<PatternEventHandler> const& patternEventHandlers, PatternEventListenerMap& patternEventListeners);
+		void eraseTargetPatternEntry(void const* eventTarget);
+		void retireEventListener(std::shared_ptr<EventListener> eventListener);
 	};
+
+	template<typename TEvent>
+	void EventDispatcher::notifyEvent(EventTarget const& eventTarget, typename TEvent::PayloadType const& eventPayload)
+	{
+		Event event{ TEvent::eventType, &eventPayload };
+		dispatchEvent(TEvent::eventType, eventTarget.get(), event);
+	}
 }
 
 
@@ -131,21 +392,90 @@ namespace cx::ev::target
 {
 	class EventHandlerRegistry
 	{
+	private:
+		// EventTarget 별로 등록한 (EventType, Token) 목록과 범위 구독 PatternToken 목록
+		struct EventTargetEntry
+		{
+			WeakEventTarget _EventTarget;
+			std::vector<std::pair<EventType, EventListener::Token>> _EventTypeTokens;
+			std::vector<EventDispatcher::PatternToken> _PatternTokens;
+		};
+
 	private:
 		EventDispatcher& _EventDispatcher;
-		std::vector<std::pair<EventId, EventListener::Token>> _EventIdTokens;
+		FlatHashMap<void const*, EventTargetEntry> _EventTargetEntries;
+		// 이 EventHandlerRegistry 로 등록한 EventTarget 범위 구독의 PatternToken -> EventTarget
+		FlatHashMap<EventDispatcher::PatternToken, void const*> _PatternTokenTargets;
+		std::size_t _SweepThreshold{ 64 };
+
+		// Subscription 이 EventHandlerRegistry 가 살아 있는지 확인하는 데 사용, 그래서 복사/이동 불가
+		std::shared_ptr<EventHandlerRegistry*> _Self{ std::make_shared<EventHandlerRegistry*>(this) };
 
 	public:
 		explicit EventHandlerRegistry(EventDispatcher& eventDispatcher);
 
+	public:
+		EventHandlerRegistry(EventHandlerRegistry const&) = delete;
+		EventHandlerRegistry& operator=(EventHandlerRegistry const&) = delete;
+
 	public:
 		void registerEventHandler(
 			EventType const eventType,
 			EventTarget const& eventTarget,
-			EventHandler const& eventHandler
+			EventHandler const& eventHandler,
+			EventHandlerPriority const priority = 0
+		);
+		template<typename TEvent, typename Handler>
+		void registerEventHandler(EventTarget const& eventTarget, Handler&& handler, EventHandlerPriority const priority = 0);
+		void registerEventHandler(
+			EventTypeRange const& eventTypes,
+			EventTarget const& eventTarget,
+			EventHandler const& eventHandler,
+			EventHandlerPriority const priority = 0
 		);
+		// 모든 EventTarget 대상, 반환된 PatternToken 으로 해제
+		EventDispatcher::PatternToken registerEventHandler(
+			EventTypeRange const& eventTypes,
+			EventHandler const& eventHandler,
+			EventHandlerPriority const priority = 0
+		);
+		[[nodiscard]] Subscription subscribeEventHandler(
+			EventType const eventType,
+			EventTarget const& eventTarget,
+			EventHandler const& eventHandler,
+			EventHandlerPriority const priority = 0
+		);
+		// 이 EventHandlerRegistry 로 eventTarget 에 등록한 모든 handler (범위 구독 포함) 를 해제
 		void unregisterEventHandler(EventTarget const& eventTarget);
+		void unregisterEventHandler(EventDispatcher::PatternToken const token);
+		void unregisterEventHandlers(std::span<EventTarget const> eventTargets);
+		// 이미 소멸된 EventTarget 의 등록 정보를 지움, 주기적으로 호출 가능
+		std::size_t sweep();
+
+	public:
+		std::size_t eventTargetCount() const;
+
+	private:
+		friend class Subscription;
+		void unsubscribeEventHandler(EventType const eventType, WeakEventTarget const& eventTarget, std::shared_ptr<EventListener> const& eventListener, EventListener::Token const token);
+
+	private:
+		EventTargetEntry& eventTargetEntryOf(EventTarget const& eventTarget);
+		void eraseEventTargetEntry(void const* eventTarget);
+		EventListener::Token attachEventHandler(
+			EventType const eventType,
+			EventTarget const& eventTarget,
+			EventHandler const& eventHandler,
+			EventHandlerPriority const priority,
+			std::shared_ptr<EventListener>& eventListener
+		);
 	};
+
+	template<typename TEvent, typename Handler>
+	void EventHandlerRegistry::registerEventHandler(EventTarget const& eventTarget, Handler&& handler, EventHandlerPriority const priority)
+	{
+		registerEventHandler(TEvent::eventType, eventTarget, makeEventHandler<TEvent>(std::forward<Handler>(handler)), priority);
+	}
 }
 
 
@@ -2,9 +2,21 @@
 
 /////////////////////////////////////////////////////////////////////////////
 //===========================================================================
+#include <ev/cx-ev-delegate.hpp>
+#include <ev/cx-ev-memory.hpp>
 #include <ev/cx-ev-core.hpp>
+#include <ev/cx-ev-hash.hpp>
+#include <ev/cx-ev-buffer.hpp>
+#include <ev/cx-ev-instrumentation.hpp>
 #include <ev/cx-ev-key.hpp>
+#include <ev/cx-ev-static.hpp>
 #include <ev/cx-ev-target.hpp>
+#include <ev/cx-ev-propagation.hpp>
+#include <ev/cx-ev-coalesce.hpp>
+#include <ev/cx-ev-deferred.hpp>
+#include <ev/cx-ev-concurrent.hpp>
+#include <ev/cx-ev-async.hpp>
+#include <ev/cx-ev-strand.hpp>
 
 
 
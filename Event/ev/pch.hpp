@@ -1,8 +1,29 @@
 ﻿#pragma once
 
 #include <iostream>
+#include <cassert>
 #include <memory>
+#include <memory_resource>
 #include <map>
-#include <format>
 #include <functional>
-#include <unordered_map>
\ No newline at end of file
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+#include <span>
+#include <algorithm>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <bit>
+#include <tuple>
+#include <utility>
+#include <limits>
@@ -7,6 +7,8 @@
 #include <functional>
 #include <unordered_map>
 
+#include "ev/pch.hpp"
+
 /////////////////////////////////////////////////////////////////////////////
 //===========================================================================
 #include "ev/cx-ev.hpp"
@@ -114,43 +116,43 @@ void test1(void)
 	eventHandlerRegistry.registerEventHandler(
 		EventType_A,
 		object1,
-		std::bind(&app::Object::eventHandler_A, object1, std::placeholders::_1)
+		ev::makeWeakEventHandler<&app::Object::eventHandler_A>(object1)
 	);
 	eventHandlerRegistry.registerEventHandler(
 		EventType_B,
 		object1,
-		std::bind(&app::Object::eventHandler_B, object1, std::placeholders::_1)
+		ev::makeWeakEventHandler<&app::Object::eventHandler_B>(object1)
 	);
 
 	eventHandlerRegistry.registerEventHandler(
 		EventType_A,
 		object2,
-		std::bind(&app::Object::eventHandler_A, object2, std::placeholders::_1)
+		ev::makeWeakEventHandler<&app::Object::eventHandler_A>(object2)
 	);
 	eventHandlerRegistry.registerEventHandler(
 		EventType_B,
 		object2,
-		std::bind(&app::Object::eventHandler_B, object2, std::placeholders::_1)
+		ev::makeWeakEventHandler<&app::Object::eventHandler_B>(object2)
 	);
 	eventHandlerRegistry.registerEventHandler(
 		EventType_C,
 		object2,
-		std::bind(&app::Object::eventHandler_C, object2, std::placeholders::_1)
+		ev::makeWeakEventHandler<&app::Object::eventHandler_C>(object2)
 	);
 
-	eventDispatcher.notifyEvent(EventType_A, object1, std::make_shared<app::ObjectEventData>(101));
-	eventDispatcher.notifyEvent(EventType_B, object1, std::make_shared<app::ObjectEventData>(102));
-	eventDispatcher.notifyEvent(EventType_A, object2, std::make_shared<app::ObjectEventData>(103));
-	eventDispatcher.notifyEvent(EventType_B, object2, std::make_shared<app::ObjectEventData>(104));
+	eventDispatcher.notifyEvent(EventType_A, object1, ev::makeEventData<app::ObjectEventData>(101));
+	eventDispatcher.notifyEvent(EventType_B, object1, ev::makeEventData<app::ObjectEventData>(102));
+	eventDispatcher.notifyEvent(EventType_A, object2, ev::makeEventData<app::ObjectEventData>(103));
+	eventDispatcher.notifyEvent(EventType_B, object2, ev::makeEventData<app::ObjectEventData>(104));
 
 
 	eventHandlerRegistry.unregisterEventHandler(object1);
 
 
-	eventDispatcher.notifyEvent(EventType_B, object1, std::make_shared<app::ObjectEventData>(105));
-	eventDispatcher.notifyEvent(EventType_B, object2, std::make_shared<app::ObjectEventData>(106));
+	eventDispatcher.notifyEvent(EventType_B, object1, ev::makeEventData<app::ObjectEventData>(105));
+	eventDispatcher.notifyEvent(EventType_B, object2, ev::makeEventData<app::ObjectEventData>(106));
 	eventDispatcher.notifyEvent(EventType_C, object2, nullptr);
-	eventDispatcher.notifyEvent(EventType_C, object2, std::make_shared<app::ObjectEventData>(107));
+	eventDispatcher.notifyEvent(EventType_C, object2, ev::makeEventData<app::ObjectEventData>(107));
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -182,15 +184,15 @@ void test2(void)
 		std::bind(&app::Object::eventHandler_B, object2, std::placeholders::_1)
 	);
 
-	std::shared_ptr<ev::EventData> eventData = std::make_shared<app::ObjectEventData>(101);
+	std::shared_ptr<ev::EventData> eventData = ev::makeEventData<app::ObjectEventData>(101);
 	ev::Event event_A{ EventType_A, eventData };
 	eventListener.notify(event_A);
-	eventListener.notify(EventType_B, std::make_shared<app::ObjectEventData>(102));
+	eventListener.notify(EventType_B, ev::makeEventData<app::ObjectEventData>(102));
 
 	eventListener.detach(reinterpret_cast<std::uintptr_t>(object1.get()));
 
-	eventListener.notify(EventType_A, std::make_shared<app::ObjectEventData>(103));
-	eventListener.notify(EventType_B, std::make_shared<app::ObjectEventData>(104));
+	eventListener.notify(EventType_A, ev::makeEventData<app::ObjectEventData>(103));
+	eventListener.notify(EventType_B, ev::makeEventData<app::ObjectEventData>(104));
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -235,19 +237,55 @@ void test3(void)
 		std::bind(&app::Object::eventHandler_C, object2, std::placeholders::_1)
 	);
 
-	eventDispatcher.notifyEvent(EventType_A, std::make_shared<app::ObjectEventData>(101));
-	eventDispatcher.notifyEvent(EventType_B, std::make_shared<app::ObjectEventData>(102));
-	eventDispatcher.notifyEvent(EventType_A, std::make_shared<app::ObjectEventData>(103));
-	eventDispatcher.notifyEvent(EventType_B, std::make_shared<app::ObjectEventData>(104));
+	eventDispatcher.notifyEvent(EventType_A, ev::makeEventData<app::ObjectEventData>(101));
+	eventDispatcher.notifyEvent(EventType_B, ev::makeEventData<app::ObjectEventData>(102));
+	eventDispatcher.notifyEvent(EventType_A, ev::makeEventData<app::ObjectEventData>(103));
+	eventDispatcher.notifyEvent(EventType_B, ev::makeEventData<app::ObjectEventData>(104));
 
 
 	eventHandlerRegistry.unregisterEventHandler(reinterpret_cast<std::uintptr_t>(object1.get()));
 
 
-	eventDispatcher.notifyEvent(EventType_B, std::make_shared<app::ObjectEventData>(105));
-	eventDispatcher.notifyEvent(EventType_B, std::make_shared<app::ObjectEventData>(106));
+	eventDispatcher.notifyEvent(EventType_B, ev::makeEventData<app::ObjectEventData>(105));
+	eventDispatcher.notifyEvent(EventType_B, ev::makeEventData<app::ObjectEventData>(106));
 	eventDispatcher.notifyEvent(EventType_C, nullptr);
-	eventDispatcher.notifyEvent(EventType_C, std::make_shared<app::ObjectEventData>(107));
+	eventDispatcher.notifyEvent(EventType_C, ev::makeEventData<app::ObjectEventData>(107));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+void test4(void)
+{
+	struct ValueChanged
+	{
+		int value;
+	};
+	using EventType_ValueChanged = ev::TypedEvent<4, ValueChanged>;
+
+	std::shared_ptr<app::Object> object1 = std::make_shared<app::Object>(1);
+	std::shared_ptr<app::Object> object2 = std::make_shared<app::Object>(2);
+
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry(eventDispatcher);
+
+
+	eventHandlerRegistry.registerEventHandler<EventType_ValueChanged>(
+		object1,
+		[](ValueChanged const& valueChanged)
+		{
+			std::cout << "[1] valueChanged: value=" << valueChanged.value << std::endl;
+		}
+	);
+	eventHandlerRegistry.registerEventHandler<EventType_ValueChanged>(
+		object2,
+		[](ev::Event& event, ValueChanged const& valueChanged)
+		{
+			std::cout << "[2] valueChanged: type=" << event.eventType() << " value=" << valueChanged.value << std::endl;
+		}
+	);
+
+	eventDispatcher.notifyEvent<EventType_ValueChanged>(object1, ValueChanged{ 201 });
+	eventDispatcher.notifyEvent<EventType_ValueChanged>(object2, ValueChanged{ 202 });
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -293,6 +331,19 @@ int main()
 
 
 
+	std::cout
+		<< "-----------------------------------------------------------------"
+		<< std::endl
+		;
+	test4();
+	std::cout
+		<< std::endl
+		<< std::endl
+		<< std::endl
+		;
+
+
+
 	std::cout
 		<< "-----------------------------------------------------------------"
 		<< std::endl
@@ -0,0 +1,1558 @@
+﻿/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+#include "ev/pch.hpp"
+
+#include <stdexcept>
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+#include "ev/cx-ev.hpp"
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+using namespace cx;
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// 실패한 검사를 모두 출력하고, 하나라도 실패하면 0 이 아닌 값으로 종료
+namespace test
+{
+	struct TestCase
+	{
+		char const* name;
+		void (*function)();
+	};
+
+	std::vector<TestCase>& testCases()
+	{
+		static std::vector<TestCase> testCases;
+		return testCases;
+	}
+
+	std::size_t _FailureCount{ 0 };
+
+	struct TestRegistrar
+	{
+		TestRegistrar(char const* name, void (*function)())
+		{
+			testCases().push_back({ name, function });
+		}
+	};
+
+	void fail(char const* file, int const line, char const* expression)
+	{
+		std::cout << file << ":" << line << ": check failed: " << expression << std::endl;
+		_FailureCount++;
+	}
+}
+
+#define CX_EV_TEST(name) \
+	static void name(); \
+	static ::test::TestRegistrar name##Registrar{ #name, &name }; \
+	static void name()
+
+#define CX_EV_CHECK(expression) \
+	do { if (!(expression)) { ::test::fail(__FILE__, __LINE__, #expression); } } while (false)
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+namespace test
+{
+	class ValueData : public ev::EventData
+	{
+	public:
+		int value;
+
+	public:
+		explicit ValueData(int const val) : value(val)
+		{
+		}
+	};
+
+	struct Payload
+	{
+		int value;
+	};
+
+	using PayloadChanged = ev::TypedEvent<1, Payload>;
+	using PayloadCleared = ev::TypedEvent<2, Payload>;
+
+	// 살아 있는 객체 수를 셈
+	struct Counted
+	{
+		static inline std::atomic<int> live{ 0 };
+		int value{ 0 };
+
+		Counted() { live++; }
+		Counted(Counted const& other) : value(other.value) { live++; }
+		~Counted() { live--; }
+	};
+
+	int valueOf(ev::Event const& event)
+	{
+		auto eventData = event.eventDataAs<ValueData>();
+		return eventData ? eventData->value : -1;
+	}
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// key
+CX_EV_TEST(keyListenerPriorityOrder)
+{
+	ev::key::EventListener eventListener;
+	std::string order;
+
+	eventListener.attach(1, [&order](ev::Event&) { order += "a"; });
+	eventListener.attach(2, [&order](ev::Event&) { order += "b"; }, 10);
+	eventListener.attach(3, [&order](ev::Event&) { order += "c"; });
+	eventListener.attach(4, [&order](ev::Event&) { order += "d"; }, -5);
+	eventListener.attach(5, [&order](ev::Event&) { order += "e"; }, 10);
+
+	eventListener.notify(1, nullptr);
+	CX_EV_CHECK(order == "beacd");
+}
+
+CX_EV_TEST(keyListenerHandledStopsChain)
+{
+	ev::key::EventListener eventListener;
+	int count = 0;
+
+	eventListener.attach(1, [&count](ev::Event& event) { count++; event.handled(true); });
+	eventListener.attach(2, [&count](ev::Event&) { count++; });
+
+	eventListener.notify(1, nullptr);
+	CX_EV_CHECK(count == 1);
+}
+
+CX_EV_TEST(keyListenerReentrantAttachDetach)
+{
+	ev::key::EventListener eventListener;
+	std::string order;
+
+	eventListener.attach(1,
+		[&](ev::Event&)
+		{
+			order += "a";
+			eventListener.detach(2);
+			eventListener.attach(3, [&order](ev::Event&) { order += "c"; });
+			eventListener.detach(1);
+		}
+	);
+	eventListener.attach(2, [&order](ev::Event&) { order += "b"; });
+
+	// 같은 notify 안에서 detach 된 handler 는 호출되지 않고, attach 된 handler 는 다음 notify 부터 호출됨
+	eventListener.notify(1, nullptr);
+	CX_EV_CHECK(order == "a");
+
+	order.clear();
+	eventListener.notify(1, nullptr);
+	CX_EV_CHECK(order == "c");
+}
+
+CX_EV_TEST(keyListenerDetachFromHandlerDestructor)
+{
+	// handler 1 이 소멸될 때 key 4 를 detach 하는 guard 를 붙잡고 있음
+	struct DetachGuard
+	{
+		ev::key::EventListener* eventListener;
+		~DetachGuard()
+		{
+			if (eventListener)
+			{
+				eventListener->detach(4);
+			}
+		}
+	};
+
+	ev::key::EventListener eventListener;
+	int count = 0;
+
+	auto guard = std::make_shared<DetachGuard>(DetachGuard{ &eventListener });
+	eventListener.attach(1, [guard](ev::Event&) {});
+	guard.reset();
+	eventListener.attach(2,
+		[&eventListener](ev::Event&)
+		{
+			eventListener.detach(1);
+			eventListener.detach(2);
+			eventListener.detach(3);
+		}
+	);
+	eventListener.attach(3, [](ev::Event&) {});
+	eventListener.attach(4, [&count](ev::Event&) { count++; });
+	eventListener.attach(5, [&count](ev::Event&) { count += 10; });
+
+	eventListener.notify(1, nullptr);
+	CX_EV_CHECK(count == 11);
+
+	count = 0;
+	eventListener.notify(1, nullptr);
+	CX_EV_CHECK(count == 10);
+
+	// notify 밖에서 detach 해도 같음
+	guard = std::make_shared<DetachGuard>(DetachGuard{ &eventListener });
+	eventListener.attach(6, [guard](ev::Event&) {});
+	guard.reset();
+	eventListener.attach(4, [&count](ev::Event&) { count++; });
+	eventListener.detach(6);
+	count = 0;
+	eventListener.notify(1, nullptr);
+	CX_EV_CHECK(count == 10);
+}
+
+CX_EV_TEST(targetListenerDetachFromHandlerDestructor)
+{
+	auto eventListener = std::make_shared<ev::target::EventListener>();
+	int count = 0;
+
+	// 소멸 시 다른 handler 를 detach 하는 Subscription 을 붙잡은 handler
+	auto subscription = std::make_shared<ev::target::Subscription>(eventListener->subscribe([&count](ev::Event&) { count++; }));
+	auto const tokenA = eventListener->attach([subscription](ev::Event&) {});
+	subscription.reset();
+	std::vector<ev::target::EventListener::Token> tokens;
+	tokens.push_back(eventListener->attach(
+		[&](ev::Event&)
+		{
+			eventListener->detach(tokenA);
+			for (auto const token : tokens)
+			{
+				eventListener->detach(token);
+			}
+		}
+	));
+	tokens.push_back(eventListener->attach([](ev::Event&) {}));
+	eventListener->attach([&count](ev::Event&) { count += 10; });
+
+	eventListener->notify(1, nullptr);
+	CX_EV_CHECK(count == 11);
+
+	count = 0;
+	eventListener->notify(1, nullptr);
+	CX_EV_CHECK(count == 10);
+}
+
+CX_EV_TEST(keyDispatcherUnregisterByKey)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	std::vector<int> values;
+
+	eventDispatcher.registerEventHandler(1, 10, [&values](ev::Event& event) { values.push_back(test::valueOf(event)); });
+	eventDispatcher.registerEventHandler(2, 10, [&values](ev::Event& event) { values.push_back(test::valueOf(event) * 10); });
+	eventDispatcher.registerEventHandler(2, 20, [&values](ev::Event& event) { values.push_back(test::valueOf(event) * 100); });
+
+	eventDispatcher.notifyEvent(1, ev::makeEventData<test::ValueData>(1));
+	eventDispatcher.notifyEvent(2, ev::makeEventData<test::ValueData>(2));
+	CX_EV_CHECK((values == std::vector<int>{ 1, 20, 200 }));
+
+	values.clear();
+	eventDispatcher.unregisterEventHandler(10);
+	eventDispatcher.notifyEvent(1, ev::makeEventData<test::ValueData>(3));
+	eventDispatcher.notifyEvent(2, ev::makeEventData<test::ValueData>(4));
+	CX_EV_CHECK((values == std::vector<int>{ 400 }));
+	CX_EV_CHECK(eventDispatcher.findEventListener(1) == nullptr);
+}
+
+CX_EV_TEST(keyDispatcherIndirectEventType)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	int count = 0;
+
+	eventDispatcher.registerEventHandler(-7, 1, [&count](ev::Event&) { count++; });
+	eventDispatcher.registerEventHandler(100000, 1, [&count](ev::Event&) { count += 10; });
+
+	eventDispatcher.notifyEvent(-7, nullptr);
+	eventDispatcher.notifyEvent(100000, nullptr);
+	CX_EV_CHECK(count == 11);
+}
+
+CX_EV_TEST(keyDispatcherKeepsListenerAliveDuringDispatch)
+{
+	// dispatch 는 EventListener 를 raw pointer 로 찾으므로, handler 안에서 해제된 EventListener 는 dispatch 가 끝날 때까지 살아 있어야 함
+	for (ev::EventType const eventType : { ev::EventType{ 1 }, ev::EventType{ 100000 } })
+	{
+		ev::key::EventDispatcher eventDispatcher;
+		std::string order;
+
+		auto eventListener = std::make_shared<ev::key::EventListener>();
+		std::weak_ptr<ev::key::EventListener> weakEventListener = eventListener;
+		eventListener->attach(1,
+			[&](ev::Event&)
+			{
+				order += "a";
+				eventDispatcher.unregisterEventListener(eventType);
+				auto replacement = std::make_shared<ev::key::EventListener>();
+				replacement->attach(1, [&order](ev::Event&) { order += "r"; });
+				eventDispatcher.registerEventListener(eventType, replacement);
+				order += weakEventListener.expired() ? "!" : "";
+			}
+		);
+		eventListener->attach(2, [&order](ev::Event&) { order += "b"; });
+		eventDispatcher.registerEventListener(eventType, std::move(eventListener));
+
+		eventDispatcher.notifyEvent(eventType, nullptr);
+		CX_EV_CHECK(order == "ab");
+		CX_EV_CHECK(weakEventListener.expired());
+
+		// notifyEvents 도 같은 보호를 받고, 교체된 EventListener 를 다시 찾음
+		order.clear();
+		auto batchEventListener = std::make_shared<ev::key::EventListener>();
+		weakEventListener = batchEventListener;
+		batchEventListener->attach(1,
+			[&](ev::Event&)
+			{
+				order += "a";
+				eventDispatcher.unregisterEventListener(eventType);
+				order += weakEventListener.expired() ? "!" : "";
+			}
+		);
+		eventDispatcher.registerEventListener(eventType, std::move(batchEventListener));
+
+		std::vector<ev::Event> events{ ev::Event{ eventType }, ev::Event{ eventType } };
+		eventDispatcher.notifyEvents(events);
+		CX_EV_CHECK(order == "a");
+		CX_EV_CHECK(weakEventListener.expired());
+	}
+}
+
+CX_EV_TEST(keyDispatcherBatchNotify)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	std::vector<int> values;
+
+	eventDispatcher.registerEventHandler(1, 1, [&values](ev::Event& event) { values.push_back(test::valueOf(event)); });
+	eventDispatcher.registerEventHandler(2, 1, [&values](ev::Event& event) { values.push_back(-test::valueOf(event)); });
+
+	std::vector<std::shared_ptr<ev::EventData>> eventData{
+		ev::makeEventData<test::ValueData>(1),
+		ev::makeEventData<test::ValueData>(2),
+		ev::makeEventData<test::ValueData>(3),
+		ev::makeEventData<test::ValueData>(4)
+	};
+	std::vector<ev::Event> events{
+		ev::Event{ 1, eventData[0] },
+		ev::Event{ 1, eventData[1] },
+		ev::Event{ 2, eventData[2] },
+		ev::Event{ 1, eventData[3] }
+	};
+	eventDispatcher.notifyEvents(events);
+	CX_EV_CHECK((values == std::vector<int>{ 1, 2, -3, 4 }));
+}
+
+CX_EV_TEST(keyDispatcherBatchMatchesSequentialOrder)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	std::string order;
+
+	eventDispatcher.registerEventHandler(1, 1, [&order](ev::Event& event) { order += "x"; order += std::to_string(test::valueOf(event)); });
+	eventDispatcher.registerEventHandler(ev::EventTypeRange::all(), 2, [&order](ev::Event& event) { order += "*"; order += std::to_string(test::valueOf(event)); });
+
+	std::vector<std::shared_ptr<ev::EventData>> eventData{
+		ev::makeEventData<test::ValueData>(1),
+		ev::makeEventData<test::ValueData>(2)
+	};
+	std::vector<ev::Event> events{
+		ev::Event{ 1, eventData[0] },
+		ev::Event{ 1, eventData[1] }
+	};
+	eventDispatcher.notifyEvents(events);
+	CX_EV_CHECK(order == "x1*1x2*2");
+
+	// 첫 이벤트에서 EventListener 를 해제하면 남은 이벤트는 정확한 EventType handler 에 가지 않음
+	eventDispatcher.registerEventHandler(1, 3, [&](ev::Event&) { eventDispatcher.unregisterEventListener(1); }, 10);
+	order.clear();
+	eventDispatcher.notifyEvents(events);
+	CX_EV_CHECK(order == "x1*1*2");
+}
+
+CX_EV_TEST(keyDispatcherRangeSubscription)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	std::string order;
+
+	eventDispatcher.registerEventHandler(ev::EventTypeRange{ 10, 20 }, 1, [&order](ev::Event&) { order += "r"; });
+	eventDispatcher.registerEventHandler(ev::EventTypeRange::all(), 2, [&order](ev::Event&) { order += "*"; }, 5);
+	eventDispatcher.registerEventHandler(15, 3, [&order](ev::Event&) { order += "x"; });
+
+	eventDispatcher.notifyEvent(15, nullptr);
+	CX_EV_CHECK(order == "x*r");
+
+	order.clear();
+	eventDispatcher.notifyEvent(25, nullptr);
+	CX_EV_CHECK(order == "*");
+
+	order.clear();
+	eventDispatcher.unregisterEventHandler(2);
+	eventDispatcher.notifyEvent(15, nullptr);
+	eventDispatcher.notifyEvent(25, nullptr);
+	CX_EV_CHECK(order == "xr");
+}
+
+CX_EV_TEST(keyDispatcherOverlappingRangeSubscription)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	std::string order;
+
+	eventDispatcher.registerEventHandler(ev::EventTypeRange{ 10, 30 }, 1, [&order](ev::Event&) { order += "a"; });
+	eventDispatcher.registerEventHandler(ev::EventTypeRange{ 20, 40 }, 2, [&order](ev::Event&) { order += "b"; }, 5);
+	eventDispatcher.registerEventHandler(ev::EventTypeRange::only(std::numeric_limits<ev::EventType>::max()), 3, [&order](ev::Event&) { order += "m"; });
+
+	for (ev::EventType const eventType : { 9, 10, 19, 20, 29, 30, 39, 40 })
+	{
+		eventDispatcher.notifyEvent(eventType, nullptr);
+		order += "|";
+	}
+	CX_EV_CHECK(order == "|a|a|ba|ba|b|b||");
+
+	order.clear();
+	eventDispatcher.notifyEvent(std::numeric_limits<ev::EventType>::max(), nullptr);
+	eventDispatcher.notifyEvent(std::numeric_limits<ev::EventType>::min(), nullptr);
+	CX_EV_CHECK(order == "m");
+
+	order.clear();
+	eventDispatcher.unregisterEventHandler(1);
+	eventDispatcher.notifyEvent(15, nullptr);
+	eventDispatcher.notifyEvent(25, nullptr);
+	CX_EV_CHECK(order == "b");
+}
+
+CX_EV_TEST(keyTypedEventPayload)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	ev::key::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	int sum = 0;
+
+	eventHandlerRegistry.registerEventHandler<test::PayloadChanged>(1, [&sum](test::Payload const& payload) { sum += payload.value; });
+	eventHandlerRegistry.registerEventHandler<test::PayloadChanged>(2,
+		[&sum](ev::Event& event, test::Payload const& payload)
+		{
+			CX_EV_CHECK(event.eventType() == test::PayloadChanged::eventType);
+			sum += payload.value * 10;
+		}
+	);
+
+	eventDispatcher.notifyEvent<test::PayloadChanged>(test::Payload{ 3 });
+	CX_EV_CHECK(sum == 33);
+}
+
+CX_EV_TEST(eventRemembersPayloadType)
+{
+	test::Payload const payload{ 5 };
+	ev::Event event{ test::PayloadChanged::eventType, &payload };
+	CX_EV_CHECK(event.eventPayloadIs<test::Payload>());
+	CX_EV_CHECK(!event.eventPayloadIs<int>());
+	CX_EV_CHECK(event.eventPayloadAs<test::Payload>().value == 5);
+
+	// 타입을 지운 payload 는 payloadTypeIdOf 로 타입을 함께 넘김
+	ev::Event erased{ test::PayloadChanged::eventType, static_cast<void const*>(&payload), ev::payloadTypeIdOf<test::Payload>() };
+	CX_EV_CHECK(erased.eventPayloadType() == event.eventPayloadType());
+
+	ev::Event empty{ test::PayloadChanged::eventType };
+	CX_EV_CHECK(empty.eventPayload() == nullptr);
+	CX_EV_CHECK(!empty.eventPayloadIs<test::Payload>());
+
+	// DeferredEventQueue 를 거쳐도 payload 타입이 남음
+	ev::key::EventDispatcher eventDispatcher;
+	ev::key::DeferredEventQueue deferredEventQueue{ eventDispatcher };
+	bool typed = false;
+	eventDispatcher.registerEventHandler(test::PayloadChanged::eventType, 1, [&typed](ev::Event& event) { typed = event.eventPayloadIs<test::Payload>(); });
+	deferredEventQueue.postEvent<test::PayloadChanged>(payload);
+	deferredEventQueue.processQueue();
+	CX_EV_CHECK(typed);
+}
+
+CX_EV_TEST(keySubscriptionDetachesOnDestruction)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	ev::key::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	int count = 0;
+
+	{
+		auto subscription = eventHandlerRegistry.subscribeEventHandler(1, 7, [&count](ev::Event&) { count++; });
+		CX_EV_CHECK(static_cast<bool>(subscription));
+		eventDispatcher.notifyEvent(1, nullptr);
+	}
+	eventDispatcher.notifyEvent(1, nullptr);
+	CX_EV_CHECK(count == 1);
+}
+
+CX_EV_TEST(keySubscriptionKeepsReattachedHandler)
+{
+	auto eventListener = std::make_shared<ev::key::EventListener>();
+	int count = 0;
+
+	auto subscription = eventListener->subscribe(7, [&count](ev::Event&) { count++; });
+	// 같은 Key 로 다시 attach, 이전 Subscription 은 새 handler 를 떼어내지 않아야 함
+	eventListener->attach(7, [&count](ev::Event&) { count += 10; });
+	subscription.reset();
+	eventListener->notify(1, nullptr);
+	CX_EV_CHECK(count == 10);
+
+	// notify 중에 다시 attach 되어 아직 붙이기 전인 handler 도 마찬가지
+	subscription = eventListener->subscribe(8, [&count](ev::Event&) { count += 100; });
+	eventListener->attach(9,
+		[&](ev::Event&)
+		{
+			eventListener->attach(8, [&count](ev::Event&) { count += 1000; });
+			subscription.reset();
+			eventListener->detach(9);
+		}
+	);
+	count = 0;
+	eventListener->notify(1, nullptr);
+	eventListener->notify(1, nullptr);
+	CX_EV_CHECK(count == 10 + 100 + 10 + 1000);
+}
+
+CX_EV_TEST(keyDispatcherSubscriptionCleansUp)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	ev::key::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	int count = 0;
+
+	{
+		auto subscription = eventHandlerRegistry.subscribeEventHandler(1, 7, [&count](ev::Event&) { count++; });
+		CX_EV_CHECK(eventDispatcher.findEventListener(1) != nullptr);
+	}
+	// 마지막 handler 가 빠진 EventListener 는 EventDispatcher 에서도 해제
+	CX_EV_CHECK(eventDispatcher.findEventListener(1) == nullptr);
+
+	auto subscription = eventHandlerRegistry.subscribeEventHandler(2, 7, [&count](ev::Event&) { count++; });
+	eventHandlerRegistry.registerEventHandler(2, 7, [&count](ev::Event&) { count += 10; });
+	subscription.reset();
+	eventDispatcher.notifyEvent(2, nullptr);
+	CX_EV_CHECK(count == 10);
+
+	// Key 별 기록이 남아 있어 unregisterEventHandler 로 다시 등록한 handler 를 해제할 수 있음
+	eventHandlerRegistry.unregisterEventHandler(7);
+	eventDispatcher.notifyEvent(2, nullptr);
+	CX_EV_CHECK(count == 10);
+	CX_EV_CHECK(eventDispatcher.findEventListener(2) == nullptr);
+
+	// EventDispatcher 보다 오래 남은 Subscription 은 아무것도 하지 않음
+	auto shortLived = std::make_unique<ev::key::EventDispatcher>();
+	subscription = shortLived->subscribeEventHandler(3, 7, [&count](ev::Event&) { count++; });
+	auto eventListener = shortLived->getEventListener(3);
+	shortLived.reset();
+	subscription.reset();
+	CX_EV_CHECK(eventListener->empty());
+}
+
+CX_EV_TEST(keyStaticDispatcher)
+{
+	ev::key::StaticEventDispatcher<test::PayloadChanged, test::PayloadCleared> eventDispatcher;
+	int changed = 0;
+	int cleared = 0;
+
+	eventDispatcher.registerEventHandler<test::PayloadChanged>(1, [&changed](test::Payload const& payload) { changed += payload.value; });
+	eventDispatcher.registerEventHandler<test::PayloadCleared>(1, [&cleared](test::Payload const& payload) { cleared += payload.value; });
+	eventDispatcher.registerEventHandler<test::PayloadChanged>(2, [&changed](test::Payload const& payload) { changed += payload.value * 10; });
+
+	eventDispatcher.notifyEvent<test::PayloadChanged>(test::Payload{ 1 });
+	eventDispatcher.notifyEvent<test::PayloadCleared>(test::Payload{ 2 });
+	CX_EV_CHECK(changed == 11);
+	CX_EV_CHECK(cleared == 2);
+
+	eventDispatcher.unregisterEventHandler(1);
+	eventDispatcher.notifyEvent<test::PayloadChanged>(test::Payload{ 1 });
+	eventDispatcher.notifyEvent<test::PayloadCleared>(test::Payload{ 2 });
+	CX_EV_CHECK(changed == 21);
+	CX_EV_CHECK(cleared == 2);
+}
+
+CX_EV_TEST(keyStaticDispatcherReentrantRegister)
+{
+	ev::key::StaticEventDispatcher<test::PayloadChanged, test::PayloadCleared> eventDispatcher;
+	std::string order;
+
+	eventDispatcher.registerEventHandler<test::PayloadChanged>(1,
+		[&](test::Payload const&)
+		{
+			order += "a";
+			eventDispatcher.unregisterEventHandler<test::PayloadChanged>(2);
+			eventDispatcher.registerEventHandler<test::PayloadChanged>(3, [&order](test::Payload const&) { order += "c"; });
+			for (int i = 0; i < 64; i++)
+			{
+				eventDispatcher.registerEventHandler<test::PayloadChanged>(100 + i, [](test::Payload const&) {});
+			}
+			eventDispatcher.unregisterEventHandler(1);
+		}
+	);
+	eventDispatcher.registerEventHandler<test::PayloadChanged>(2, [&order](test::Payload const&) { order += "b"; });
+
+	// 같은 notify 안에서 해제된 handler 는 호출되지 않고, 등록된 handler 는 다음 notify 부터 호출됨
+	eventDispatcher.notifyEvent<test::PayloadChanged>(test::Payload{ 0 });
+	CX_EV_CHECK(order == "a");
+
+	order.clear();
+	eventDispatcher.notifyEvent<test::PayloadChanged>(test::Payload{ 0 });
+	CX_EV_CHECK(order == "c");
+
+	// 등록 후 같은 notify 안에서 해제하면 붙지 않음
+	eventDispatcher.registerEventHandler<test::PayloadCleared>(1,
+		[&](test::Payload const&)
+		{
+			eventDispatcher.registerEventHandler<test::PayloadCleared>(2, [&order](test::Payload const&) { order += "x"; });
+			eventDispatcher.unregisterEventHandler<test::PayloadCleared>(2);
+		}
+	);
+	order.clear();
+	eventDispatcher.notifyEvent<test::PayloadCleared>(test::Payload{ 0 });
+	eventDispatcher.notifyEvent<test::PayloadCleared>(test::Payload{ 0 });
+	CX_EV_CHECK(order.empty());
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// target
+CX_EV_TEST(targetListenerStaleTokenIsHarmless)
+{
+	auto eventListener = std::make_shared<ev::target::EventListener>();
+	int a = 0;
+	int b = 0;
+
+	auto const tokenA = eventListener->attach([&a](ev::Event&) { a++; });
+	eventListener->detach(tokenA);
+
+	// 같은 slot 을 재사용해도 세대가 달라 이전 Token 으로는 지울 수 없음
+	auto const tokenB = eventListener->attach([&b](ev::Event&) { b++; });
+	CX_EV_CHECK(tokenA.index == tokenB.index);
+	CX_EV_CHECK(tokenA.generation != tokenB.generation);
+
+	eventListener->detach(tokenA);
+	eventListener->notify(1, nullptr);
+	CX_EV_CHECK(a == 0);
+	CX_EV_CHECK(b == 1);
+
+	{
+		auto subscription = eventListener->subscribe([&a](ev::Event&) { a++; });
+		eventListener->clear();
+	}
+	eventListener->notify(1, nullptr);
+	CX_EV_CHECK(a == 0);
+	CX_EV_CHECK(b == 1);
+}
+
+CX_EV_TEST(targetListenerReentrantAttachDetach)
+{
+	ev::target::EventListener eventListener;
+	std::string order;
+	ev::target::EventListener::Token tokenB{};
+
+	auto const tokenA = eventListener.attach(
+		[&](ev::Event&)
+		{
+			order += "a";
+			eventListener.detach(tokenB);
+			eventListener.attach([&order](ev::Event&) { order += "c"; });
+		}
+	);
+	tokenB = eventListener.attach([&order](ev::Event&) { order += "b"; });
+
+	eventListener.notify(1, nullptr);
+	CX_EV_CHECK(order == "a");
+
+	order.clear();
+	eventListener.detach(tokenA);
+	eventListener.notify(1, nullptr);
+	CX_EV_CHECK(order == "c");
+}
+
+CX_EV_TEST(targetDispatcherWeakTargetExpiry)
+{
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	int count = 0;
+
+	auto eventTarget = std::make_shared<int>(0);
+	std::weak_ptr<int> weakEventTarget = eventTarget;
+	eventHandlerRegistry.registerEventHandler(1, eventTarget, [&count](ev::Event&) { count++; });
+
+	eventDispatcher.notifyEvent(1, eventTarget, nullptr);
+	CX_EV_CHECK(count == 1);
+
+	// 등록만으로 EventTarget 의 수명을 늘리지 않음
+	eventTarget.reset();
+	CX_EV_CHECK(weakEventTarget.expired());
+	CX_EV_CHECK(eventHandlerRegistry.sweep() == 1);
+}
+
+CX_EV_TEST(targetDispatcherUnregisterByTarget)
+{
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	std::vector<int> values;
+
+	auto object1 = std::make_shared<int>(1);
+	auto object2 = std::make_shared<int>(2);
+	eventHandlerRegistry.registerEventHandler(1, object1, [&values](ev::Event& event) { values.push_back(test::valueOf(event)); });
+	eventHandlerRegistry.registerEventHandler(2, object1, [&values](ev::Event& event) { values.push_back(test::valueOf(event)); });
+	eventHandlerRegistry.registerEventHandler(1, object2, [&values](ev::Event& event) { values.push_back(test::valueOf(event) * 10); });
+
+	eventHandlerRegistry.unregisterEventHandler(object1);
+	eventDispatcher.notifyEvent(1, object1, ev::makeEventData<test::ValueData>(1));
+	eventDispatcher.notifyEvent(2, object1, ev::makeEventData<test::ValueData>(2));
+	eventDispatcher.notifyEvent(1, object2, ev::makeEventData<test::ValueData>(3));
+	CX_EV_CHECK((values == std::vector<int>{ 30 }));
+	CX_EV_CHECK(eventDispatcher.findEventListener(1, object1.get()) == nullptr);
+}
+
+CX_EV_TEST(targetDispatcherBatchNotify)
+{
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	std::vector<int> values;
+
+	auto object1 = std::make_shared<int>(1);
+	auto object2 = std::make_shared<int>(2);
+	eventHandlerRegistry.registerEventHandler(1, object1, [&values](ev::Event& event) { values.push_back(test::valueOf(event)); });
+	eventHandlerRegistry.registerEventHandler(1, object2, [&values](ev::Event& event) { values.push_back(test::valueOf(event) * 10); });
+
+	std::vector<std::shared_ptr<ev::EventData>> eventData{
+		ev::makeEventData<test::ValueData>(1),
+		ev::makeEventData<test::ValueData>(2),
+		ev::makeEventData<test::ValueData>(3)
+	};
+	std::vector<ev::target::EventTarget> eventTargets{ object1, object1, object2 };
+	std::vector<ev::Event> events{
+		ev::Event{ 1, eventData[0] },
+		ev::Event{ 1, eventData[1] },
+		ev::Event{ 1, eventData[2] }
+	};
+	eventDispatcher.notifyEvents(eventTargets, events);
+	CX_EV_CHECK((values == std::vector<int>{ 1, 2, 30 }));
+}
+
+CX_EV_TEST(targetDispatcherBatchMatchesSequentialOrder)
+{
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	std::string order;
+
+	auto object = std::make_shared<int>(1);
+	eventHandlerRegistry.registerEventHandler(1, object, [&order](ev::Event& event) { order += "x"; order += std::to_string(test::valueOf(event)); });
+	eventHandlerRegistry.registerEventHandler(ev::EventTypeRange::all(), [&order](ev::Event& event) { order += "*"; order += std::to_string(test::valueOf(event)); });
+
+	std::vector<std::shared_ptr<ev::EventData>> eventData{
+		ev::makeEventData<test::ValueData>(1),
+		ev::makeEventData<test::ValueData>(2)
+	};
+	std::vector<ev::Event> events{
+		ev::Event{ 1, eventData[0] },
+		ev::Event{ 1, eventData[1] }
+	};
+	eventDispatcher.notifyEvents(object, events);
+	CX_EV_CHECK(order == "x1*1x2*2");
+
+	std::vector<ev::target::EventTarget> eventTargets{ object, object };
+	order.clear();
+	eventDispatcher.notifyEvents(eventTargets, events);
+	CX_EV_CHECK(order == "x1*1x2*2");
+
+	// 첫 이벤트에서 EventListener 를 해제하면 남은 이벤트는 정확한 handler 에 가지 않음
+	eventHandlerRegistry.registerEventHandler(1, object, [&](ev::Event&) { eventDispatcher.unregisterEventListener(ev::target::EventId{ 1, object }); }, 10);
+	order.clear();
+	eventDispatcher.notifyEvents(eventTargets, events);
+	CX_EV_CHECK(order == "x1*1*2");
+}
+
+CX_EV_TEST(targetDispatcherRangeSubscription)
+{
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	std::string order;
+
+	auto object1 = std::make_shared<int>(1);
+	auto object2 = std::make_shared<int>(2);
+	eventHandlerRegistry.registerEventHandler(1, object1, [&order](ev::Event&) { order += "x"; });
+	eventHandlerRegistry.registerEventHandler(ev::EventTypeRange::all(), object1, [&order](ev::Event&) { order += "t"; });
+	auto const token = eventHandlerRegistry.registerEventHandler(ev::EventTypeRange::only(1), [&order](ev::Event&) { order += "*"; });
+
+	eventDispatcher.notifyEvent(1, object1, nullptr);
+	eventDispatcher.notifyEvent(2, object1, nullptr);
+	eventDispatcher.notifyEvent(1, object2, nullptr);
+	CX_EV_CHECK(order == "xt*t*");
+
+	order.clear();
+	eventHandlerRegistry.unregisterEventHandler(token);
+	eventHandlerRegistry.unregisterEventHandler(object1);
+	eventDispatcher.notifyEvent(1, object1, nullptr);
+	eventDispatcher.notifyEvent(1, object2, nullptr);
+	CX_EV_CHECK(order.empty());
+}
+
+CX_EV_TEST(targetRegistryUnregistersOnlyItsOwnRangeSubscriptions)
+{
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry1{ eventDispatcher };
+	ev::target::EventHandlerRegistry eventHandlerRegistry2{ eventDispatcher };
+	std::string order;
+
+	auto object1 = std::make_shared<int>(1);
+	eventHandlerRegistry1.registerEventHandler(ev::EventTypeRange::all(), object1, [&order](ev::Event&) { order += "1"; });
+	eventHandlerRegistry2.registerEventHandler(ev::EventTypeRange::all(), object1, [&order](ev::Event&) { order += "2"; });
+	auto const token = eventDispatcher.registerPatternEventHandler(ev::EventTypeRange::all(), object1, [&order](ev::Event&) { order += "d"; });
+
+	eventHandlerRegistry1.unregisterEventHandler(object1);
+	eventDispatcher.notifyEvent(1, object1, nullptr);
+	CX_EV_CHECK(order == "2d");
+	CX_EV_CHECK(eventHandlerRegistry1.eventTargetCount() == 0);
+
+	eventDispatcher.unregisterPatternEventHandler(token);
+	eventHandlerRegistry2.unregisterEventHandler(object1);
+	order.clear();
+	eventDispatcher.notifyEvent(1, object1, nullptr);
+	CX_EV_CHECK(order.empty());
+	CX_EV_CHECK(eventHandlerRegistry2.eventTargetCount() == 0);
+}
+
+CX_EV_TEST(targetSubscriptionCleansUp)
+{
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	int count = 0;
+
+	auto object1 = std::make_shared<int>(1);
+	for (int i = 0; i < 100; i++)
+	{
+		auto subscription = eventHandlerRegistry.subscribeEventHandler(1, object1, [&count](ev::Event&) { count++; });
+		CX_EV_CHECK(eventDispatcher.findEventListener(1, object1.get()) != nullptr);
+	}
+	// 구독/해제를 반복해도 EventTarget 별 기록과 빈 EventListener 가 남지 않음
+	CX_EV_CHECK(eventHandlerRegistry.eventTargetCount() == 0);
+	CX_EV_CHECK(eventDispatcher.findEventListener(1, object1.get()) == nullptr);
+
+	auto subscription = eventHandlerRegistry.subscribeEventHandler(2, object1, [&count](ev::Event&) { count++; });
+	eventHandlerRegistry.registerEventHandler(2, object1, [&count](ev::Event&) { count += 10; });
+	subscription.reset();
+	eventDispatcher.notifyEvent(2, object1, nullptr);
+	CX_EV_CHECK(count == 10);
+	CX_EV_CHECK(eventHandlerRegistry.eventTargetCount() == 1);
+
+	// 남은 기록으로 unregisterEventHandler 가 다시 등록한 handler 를 해제할 수 있음
+	eventHandlerRegistry.unregisterEventHandler(object1);
+	eventDispatcher.notifyEvent(2, object1, nullptr);
+	CX_EV_CHECK(count == 10);
+	CX_EV_CHECK(eventDispatcher.findEventListener(2, object1.get()) == nullptr);
+
+	// EventHandlerRegistry 보다 오래 남은 Subscription 은 EventListener 에서만 detach
+	auto shortLived = std::make_unique<ev::target::EventHandlerRegistry>(eventDispatcher);
+	subscription = shortLived->subscribeEventHandler(3, object1, [&count](ev::Event&) { count++; });
+	auto eventListener = eventDispatcher.getEventListener(ev::target::EventId{ 3, object1 });
+	shortLived.reset();
+	subscription.reset();
+	CX_EV_CHECK(eventListener->empty());
+
+	// Subscription 은 EventTarget 을 붙잡지 않음
+	auto object2 = std::make_shared<int>(2);
+	std::weak_ptr<int> weakObject2 = object2;
+	subscription = eventHandlerRegistry.subscribeEventHandler(4, object2, [&count](ev::Event&) { count++; });
+	object2.reset();
+	CX_EV_CHECK(weakObject2.expired());
+	subscription.reset();
+}
+
+CX_EV_TEST(targetPropagationPhases)
+{
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventDispatcher captureEventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	ev::target::EventHandlerRegistry captureEventHandlerRegistry{ captureEventDispatcher };
+
+	auto root = std::make_shared<int>(0);
+	auto parent = std::make_shared<int>(1);
+	auto child = std::make_shared<int>(2);
+	std::map<void const*, ev::target::EventTarget> parents{ { parent.get(), root }, { child.get(), parent } };
+
+	ev::target::EventPropagator eventPropagator{
+		eventDispatcher,
+		captureEventDispatcher,
+		[&parents](ev::target::EventTarget const& eventTarget) -> ev::target::EventTarget
+		{
+			auto it = parents.find(eventTarget.get());
+			return it != parents.end() ? it->second : nullptr;
+		}
+	};
+
+	std::string order;
+	auto const record =
+		[&order](char const* name)
+		{
+			return [&order, name](ev::Event& event)
+			{
+				order += name;
+				order += event.eventPhase() == ev::EventPhase::Capture ? "C " : event.eventPhase() == ev::EventPhase::Target ? "T " : "B ";
+			};
+		};
+	captureEventHandlerRegistry.registerEventHandler(1, root, record("root"));
+	captureEventHandlerRegistry.registerEventHandler(1, parent, record("parent"));
+	captureEventHandlerRegistry.registerEventHandler(1, child, record("child"));
+	eventHandlerRegistry.registerEventHandler(1, child, record("child"));
+	eventHandlerRegistry.registerEventHandler(1, parent, record("parent"));
+	eventHandlerRegistry.registerEventHandler(1, root, record("root"));
+
+	eventPropagator.notifyEvent(1, child, nullptr);
+	CX_EV_CHECK(order == "rootC parentC childT childT parentB rootB ");
+
+	order.clear();
+	eventPropagator.notifyEvent(1, child, nullptr, false);
+	CX_EV_CHECK(order == "rootC parentC childT childT ");
+
+	// handled() 에서 전파를 멈춤
+	order.clear();
+	eventHandlerRegistry.registerEventHandler(1, parent, [](ev::Event& event) { event.handled(true); });
+	eventPropagator.notifyEvent(1, child, nullptr);
+	CX_EV_CHECK(order == "rootC parentC childT childT parentB ");
+}
+
+CX_EV_TEST(targetPropagationDropsExpiredAncestor)
+{
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+
+	auto root = std::make_shared<int>(0);
+	auto parent = std::make_shared<int>(1);
+	auto child = std::make_shared<int>(2);
+	std::map<void const*, ev::target::EventTarget> parents{ { parent.get(), root }, { child.get(), parent } };
+
+	ev::target::EventPropagator eventPropagator{
+		eventDispatcher,
+		[&parents](ev::target::EventTarget const& eventTarget) -> ev::target::EventTarget
+		{
+			auto it = parents.find(eventTarget.get());
+			return it != parents.end() ? it->second : nullptr;
+		}
+	};
+
+	std::string order;
+	eventHandlerRegistry.registerEventHandler(1, child, [&order](ev::Event&) { order += "child "; });
+	eventHandlerRegistry.registerEventHandler(1, parent, [&order](ev::Event&) { order += "parent "; });
+	eventHandlerRegistry.registerEventHandler(1, root, [&order](ev::Event&) { order += "root "; });
+
+	eventPropagator.notifyEvent(1, child, nullptr);
+	CX_EV_CHECK(order == "child parent root ");
+
+	// 부모가 소멸되면 invalidatePath() 없이도 경로를 다시 구함
+	auto other = std::make_shared<int>(3);
+	eventHandlerRegistry.registerEventHandler(1, other, [&order](ev::Event&) { order += "other "; });
+	parents.erase(parent.get());
+	parents[child.get()] = other;
+	parents[other.get()] = root;
+	parent.reset();
+
+	order.clear();
+	eventPropagator.notifyEvent(1, child, nullptr);
+	CX_EV_CHECK(order == "child other root ");
+}
+
+CX_EV_TEST(targetTypedEventPayload)
+{
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	int sum = 0;
+
+	auto object = std::make_shared<int>(0);
+	eventHandlerRegistry.registerEventHandler<test::PayloadChanged>(object, [&sum](test::Payload const& payload) { sum += payload.value; });
+	eventDispatcher.notifyEvent<test::PayloadChanged>(object, test::Payload{ 5 });
+	CX_EV_CHECK(sum == 5);
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// coalesce / deferred
+CX_EV_TEST(coalescerKeepsLatestOrMerges)
+{
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	ev::target::EventCoalescer eventCoalescer{ eventDispatcher };
+	std::vector<int> values;
+
+	auto object1 = std::make_shared<int>(1);
+	auto object2 = std::make_shared<int>(2);
+	eventHandlerRegistry.registerEventHandler(1, object1, [&values](ev::Event& event) { values.push_back(test::valueOf(event)); });
+	eventHandlerRegistry.registerEventHandler(1, object2, [&values](ev::Event& event) { values.push_back(test::valueOf(event) * 10); });
+
+	for (int i = 1; i <= 5; i++)
+	{
+		eventCoalescer.postEvent(1, object1, ev::makeEventData<test::ValueData>(i));
+		eventCoalescer.postEvent(1, object2, ev::makeEventData<test::ValueData>(i));
+	}
+	CX_EV_CHECK(eventCoalescer.pendingCount() == 2);
+	CX_EV_CHECK(eventCoalescer.flush() == 2);
+	CX_EV_CHECK((values == std::vector<int>{ 5, 50 }));
+	CX_EV_CHECK(eventCoalescer.coalescedCount() == 8);
+
+	values.clear();
+	eventCoalescer.setEventDataMerger(1,
+		[](std::shared_ptr<ev::EventData>& pendingEventData, std::shared_ptr<ev::EventData> const& eventData)
+		{
+			std::static_pointer_cast<test::ValueData>(pendingEventData)->value += std::static_pointer_cast<test::ValueData>(eventData)->value;
+		}
+	);
+	for (int i = 1; i <= 4; i++)
+	{
+		eventCoalescer.postEvent(1, object1, ev::makeEventData<test::ValueData>(i));
+	}
+	eventCoalescer.flush();
+	CX_EV_CHECK((values == std::vector<int>{ 10 }));
+}
+
+CX_EV_TEST(coalescerPostFromHandlerGoesToNextFlush)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	ev::key::EventCoalescer eventCoalescer{ eventDispatcher };
+	int count = 0;
+
+	eventDispatcher.registerEventHandler(1, 1,
+		[&](ev::Event&)
+		{
+			if (count++ == 0)
+			{
+				eventCoalescer.postEvent(1, nullptr);
+			}
+		}
+	);
+
+	eventCoalescer.postEvent(1, nullptr);
+	CX_EV_CHECK(eventCoalescer.flush() == 1);
+	CX_EV_CHECK(count == 1);
+	CX_EV_CHECK(eventCoalescer.pendingCount() == 1);
+	CX_EV_CHECK(eventCoalescer.flush() == 1);
+	CX_EV_CHECK(count == 2);
+}
+
+CX_EV_TEST(coalescerRecoversFromThrowingHandler)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	ev::key::EventCoalescer eventCoalescer{ eventDispatcher };
+	int count = 0;
+
+	eventDispatcher.registerEventHandler(1, 1,
+		[&count](ev::Event&)
+		{
+			if (count++ == 0)
+			{
+				throw std::runtime_error("handler");
+			}
+		}
+	);
+
+	eventCoalescer.postEvent(1, nullptr);
+	bool thrown = false;
+	try
+	{
+		eventCoalescer.flush();
+	}
+	catch (std::runtime_error const&)
+	{
+		thrown = true;
+	}
+	CX_EV_CHECK(thrown);
+
+	// 예외 뒤에도 flush() 가 막히지 않음
+	eventCoalescer.postEvent(1, nullptr);
+	CX_EV_CHECK(eventCoalescer.flush() == 1);
+	CX_EV_CHECK(count == 2);
+}
+
+CX_EV_TEST(deferredQueueGroupsByType)
+{
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	ev::target::DeferredEventQueue deferredEventQueue{ eventDispatcher };
+	std::string order;
+
+	auto object = std::make_shared<int>(0);
+	eventHandlerRegistry.registerEventHandler<test::PayloadChanged>(object,
+		[&](test::Payload const& payload)
+		{
+			order += "c";
+			order += std::to_string(payload.value);
+			if (payload.value == 0)
+			{
+				deferredEventQueue.postEvent<test::PayloadCleared>(object, test::Payload{ 9 });
+			}
+		}
+	);
+	eventHandlerRegistry.registerEventHandler<test::PayloadCleared>(object, [&order](test::Payload const& payload) { order += "x"; order += std::to_string(payload.value); });
+
+	for (int i = 0; i < 3; i++)
+	{
+		deferredEventQueue.postEvent<test::PayloadCleared>(object, test::Payload{ i });
+		deferredEventQueue.postEvent<test::PayloadChanged>(object, test::Payload{ i });
+	}
+	CX_EV_CHECK(order.empty());
+	CX_EV_CHECK(deferredEventQueue.processQueue() == 6);
+	CX_EV_CHECK(order == "c0c1c2x0x1x2");
+
+	order.clear();
+	CX_EV_CHECK(deferredEventQueue.pendingCount() == 1);
+	CX_EV_CHECK(deferredEventQueue.processQueue() == 1);
+	CX_EV_CHECK(order == "x9");
+}
+
+CX_EV_TEST(deferredQueuePostedOrder)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	ev::key::DeferredEventQueue deferredEventQueue{ eventDispatcher, ev::DeferredEventOrder::Posted };
+	std::string order;
+
+	eventDispatcher.registerEventHandler(1, 1, [&order](ev::Event& event) { order += "a"; order += std::to_string(test::valueOf(event)); });
+	eventDispatcher.registerEventHandler(2, 1, [&order](ev::Event& event) { order += "b"; order += std::to_string(test::valueOf(event)); });
+
+	deferredEventQueue.postEvent(2, ev::makeEventData<test::ValueData>(1));
+	deferredEventQueue.postEvent(1, ev::makeEventData<test::ValueData>(2));
+	deferredEventQueue.postEvent(2, ev::makeEventData<test::ValueData>(3));
+	deferredEventQueue.processQueue();
+	CX_EV_CHECK(order == "b1a2b3");
+}
+
+CX_EV_TEST(deferredQueueRecoversFromThrowingHandler)
+{
+	ev::key::EventDispatcher eventDispatcher;
+	ev::key::DeferredEventQueue deferredEventQueue{ eventDispatcher };
+	int count = 0;
+
+	eventDispatcher.registerEventHandler(test::PayloadChanged::eventType, 1,
+		[&count](ev::Event&)
+		{
+			if (count++ == 0)
+			{
+				throw std::runtime_error("handler");
+			}
+		}
+	);
+
+	deferredEventQueue.postEvent<test::PayloadChanged>(test::Payload{ 1 });
+	bool thrown = false;
+	try
+	{
+		deferredEventQueue.processQueue();
+	}
+	catch (std::runtime_error const&)
+	{
+		thrown = true;
+	}
+	CX_EV_CHECK(thrown);
+	CX_EV_CHECK(deferredEventQueue.pendingCount() == 0);
+
+	// 예외 뒤에도 processQueue() 가 막히지 않음
+	deferredEventQueue.postEvent<test::PayloadChanged>(test::Payload{ 2 });
+	CX_EV_CHECK(deferredEventQueue.processQueue() == 1);
+	CX_EV_CHECK(count == 2);
+}
+
+CX_EV_TEST(deferredQueueDropsExpiredTarget)
+{
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	ev::target::DeferredEventQueue deferredEventQueue{ eventDispatcher };
+	std::string order;
+
+	auto kept = std::make_shared<int>(0);
+	auto dropped = std::make_shared<int>(0);
+	std::weak_ptr<int> droppedWeak = dropped;
+	eventHandlerRegistry.registerEventHandler<test::PayloadChanged>(kept, [&order](test::Payload const& payload) { order += 'k'; order += std::to_string(payload.value); });
+	eventHandlerRegistry.registerEventHandler<test::PayloadChanged>(dropped, [&order](test::Payload const& payload) { order += 'd'; order += std::to_string(payload.value); });
+
+	deferredEventQueue.postEvent<test::PayloadChanged>(kept, test::Payload{ 1 });
+	deferredEventQueue.postEvent<test::PayloadChanged>(dropped, test::Payload{ 2 });
+	deferredEventQueue.postEvent<test::PayloadChanged>(kept, test::Payload{ 3 });
+
+	// 대기 중인 이벤트가 EventTarget 을 살려두지 않음
+	dropped.reset();
+	CX_EV_CHECK(droppedWeak.expired());
+
+	CX_EV_CHECK(deferredEventQueue.processQueue() == 2);
+	CX_EV_CHECK(order == "k1k3");
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// memory
+CX_EV_TEST(flatHashMapReuseAfterClear)
+{
+	ev::FlatHashMap<int, std::shared_ptr<int>> map;
+	auto value = std::make_shared<int>(0);
+
+	for (int round = 0; round < 3; round++)
+	{
+		for (int i = 0; i < 100; i++)
+		{
+			map[i * 7] = value;
+		}
+		CX_EV_CHECK(map.size() == 100);
+		CX_EV_CHECK(value.use_count() == 101);
+
+		// clear() 는 값을 소멸시키고 빈 자리로 되돌림
+		map.clear();
+		CX_EV_CHECK(map.empty());
+		CX_EV_CHECK(value.use_count() == 1);
+		CX_EV_CHECK(map.find(7) == nullptr);
+	}
+}
+
+CX_EV_TEST(frameArenaDestroysOnReset)
+{
+	struct Counted
+	{
+		int& count;
+		~Counted()
+		{
+			count++;
+		}
+	};
+
+	int count = 0;
+	ev::FrameArena frameArena{ 256 };
+	for (int i = 0; i < 100; i++)
+	{
+		frameArena.create<Counted>(Counted{ count });
+	}
+	int const created = count;
+	frameArena.reset();
+	CX_EV_CHECK(count - created == 100);
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// concurrent / async / strand
+CX_EV_TEST(concurrentDispatchWhileRegistering)
+{
+	ev::key::ConcurrentEventDispatcher eventDispatcher;
+	std::atomic<std::uint64_t> count{ 0 };
+
+	eventDispatcher.registerEventHandler(1, 0, [&count](ev::Event&) { count.fetch_add(1, std::memory_order_relaxed); });
+
+	std::atomic<bool> stop{ false };
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 4; i++)
+	{
+		readers.emplace_back(
+			[&]()
+			{
+				while (!stop.load(std::memory_order_relaxed))
+				{
+					eventDispatcher.notifyEvent(1, nullptr);
+				}
+			}
+		);
+	}
+	for (ev::key::Key key = 1; key <= 200; key++)
+	{
+		eventDispatcher.registerEventHandler(1, key, [](ev::Event&) {});
+		eventDispatcher.unregisterEventHandler(1, key);
+	}
+	stop.store(true);
+	for (auto& reader : readers)
+	{
+		reader.join();
+	}
+
+	std::uint64_t const before = count.load();
+	eventDispatcher.notifyEvent(1, nullptr);
+	CX_EV_CHECK(count.load() == before + 1);
+}
+
+CX_EV_TEST(snapshotCellReclaimsUnderContinuousReads)
+{
+	using test::Counted;
+	using ReadGuard = ev::SnapshotCell<Counted>::ReadGuard;
+
+	{
+		ev::SnapshotCell<Counted> snapshotCell;
+
+		// 읽기가 한 번도 끊기지 않게 다음 ReadGuard 를 먼저 잡고 이전 것을 놓음
+		// 교체된 snapshot 은 계속 회수되어야 함
+		auto readGuard = std::make_unique<ReadGuard>(snapshotCell);
+		int maxLive = 0;
+		for (int i = 1; i <= 1000; i++)
+		{
+			snapshotCell.update([i](Counted& counted) { counted.value = i; return true; });
+			auto next = std::make_unique<ReadGuard>(snapshotCell);
+			CX_EV_CHECK((*next)->value == i);
+			readGuard = std::move(next);
+			maxLive = std::max(maxLive, Counted::live.load());
+		}
+		readGuard.reset();
+		CX_EV_CHECK(maxLive <= 4);
+
+		// 여러 thread 가 읽는 동안 update, 끝난 뒤 synchronize() 하면 현재 snapshot 만 남음
+		std::atomic<bool> stop{ false };
+		std::vector<std::thread> readers;
+		for (int i = 0; i < 4; i++)
+		{
+			readers.emplace_back(
+				[&]()
+				{
+					while (!stop.load(std::memory_order_relaxed))
+					{
+						auto snapshot = snapshotCell.read();
+						CX_EV_CHECK(snapshot->value >= 0);
+					}
+				}
+			);
+		}
+		for (int i = 1; i <= 1000; i++)
+		{
+			snapshotCell.update([i](Counted& counted) { counted.value = i; return true; });
+		}
+		stop.store(true);
+		for (auto& reader : readers)
+		{
+			reader.join();
+		}
+
+		snapshotCell.synchronize();
+		CX_EV_CHECK(Counted::live.load() == 1);
+	}
+	CX_EV_CHECK(Counted::live.load() == 0);
+}
+
+CX_EV_TEST(concurrentSynchronizeWaitsForRunningHandlers)
+{
+	ev::key::ConcurrentEventDispatcher eventDispatcher;
+	std::atomic<bool> entered{ false };
+	std::atomic<bool> leave{ false };
+	std::atomic<bool> synchronized{ false };
+
+	eventDispatcher.registerEventHandler(1, 0,
+		[&](ev::Event&)
+		{
+			entered.store(true);
+			while (!leave.load())
+			{
+				std::this_thread::yield();
+			}
+		}
+	);
+
+	std::thread notifier{ [&]() { eventDispatcher.notifyEvent(1, nullptr); } };
+	while (!entered.load())
+	{
+		std::this_thread::yield();
+	}
+
+	// 해제만으로는 실행 중인 handler 가 끝났다는 보장이 없음, synchronize() 는 끝날 때까지 기다림
+	eventDispatcher.unregisterEventHandler(1, 0);
+	std::thread synchronizer{ [&]() { eventDispatcher.synchronize(); synchronized.store(true); } };
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	CX_EV_CHECK(!synchronized.load());
+
+	leave.store(true);
+	notifier.join();
+	synchronizer.join();
+	CX_EV_CHECK(synchronized.load());
+}
+
+CX_EV_TEST(concurrentTargetDispatcherPrunesExpiredTargets)
+{
+	ev::target::ConcurrentEventDispatcher eventDispatcher;
+	int count = 0;
+
+	// weak_ptr 를 남겨 두어 소멸된 EventTarget 의 주소가 재사용되지 않게 함
+	std::vector<std::weak_ptr<int>> expiredObjects;
+	for (int i = 0; i < 4000; i++)
+	{
+		auto object = std::make_shared<int>(i);
+		eventDispatcher.registerEventHandler(1, object, [&count](ev::Event&) { count += 100; });
+		expiredObjects.push_back(object);
+	}
+
+	auto object = std::make_shared<int>(0);
+	eventDispatcher.registerEventHandler(1, object, [&count](ev::Event&) { count++; });
+
+	// 등록하는 동안 대부분 정리되어 sweep() 에는 일부만 남음
+	std::size_t const swept = eventDispatcher.sweep();
+	CX_EV_CHECK(swept > 0 && swept < expiredObjects.size());
+	CX_EV_CHECK(eventDispatcher.sweep() == 0);
+
+	eventDispatcher.notifyEvent(1, object, nullptr);
+	CX_EV_CHECK(count == 1);
+}
+
+CX_EV_TEST(asyncDispatcherDeliversAll)
+{
+	ev::key::ConcurrentEventDispatcher eventDispatcher;
+	std::atomic<int> sum{ 0 };
+	eventDispatcher.registerEventHandler(1, 0, [&sum](ev::Event& event) { sum.fetch_add(test::valueOf(event)); });
+
+	ev::key::AsyncEventDispatcher<ev::key::ConcurrentEventDispatcher> asyncEventDispatcher{ eventDispatcher, 2, 16 };
+	for (int i = 1; i <= 100; i++)
+	{
+		CX_EV_CHECK(asyncEventDispatcher.postEvent(1, ev::makeEventData<test::ValueData>(i)));
+	}
+	asyncEventDispatcher.flush();
+	CX_EV_CHECK(sum.load() == 5050);
+	CX_EV_CHECK(asyncEventDispatcher.droppedCount() == 0);
+}
+
+CX_EV_TEST(asyncDispatcherAllowsRegistrationWhileRunning)
+{
+	// 기본 TEventDispatcher 는 ConcurrentEventDispatcher 이므로 worker 가 통지하는 중에 등록/해제해도 됨
+	ev::target::ConcurrentEventDispatcher eventDispatcher;
+	ev::target::AsyncEventDispatcher<> asyncEventDispatcher{ eventDispatcher, 2, 16 };
+	std::atomic<int> count{ 0 };
+
+	auto object = std::make_shared<int>(0);
+	auto const token = eventDispatcher.registerEventHandler(1, object, [&count](ev::Event&) { count++; });
+	for (int i = 0; i < 200; i++)
+	{
+		CX_EV_CHECK(asyncEventDispatcher.postEvent(1, object, nullptr));
+		if (i % 10 == 0)
+		{
+			auto const extra = eventDispatcher.registerEventHandler(1, object, [](ev::Event&) {});
+			eventDispatcher.unregisterEventHandler(1, object, extra);
+		}
+	}
+	asyncEventDispatcher.flush();
+	CX_EV_CHECK(count.load() == 200);
+
+	eventDispatcher.unregisterEventHandler(1, object, token);
+}
+
+CX_EV_TEST(strandPreservesPerTargetOrder)
+{
+	ev::target::ConcurrentEventDispatcher eventDispatcher;
+	ev::WorkStealingExecutor executor{ 4 };
+
+	std::vector<ev::target::EventTarget> eventTargets;
+	std::vector<std::vector<int>> received(8);
+	for (std::size_t i = 0; i < received.size(); i++)
+	{
+		eventTargets.push_back(std::make_shared<int>(static_cast<int>(i)));
+		// 같은 EventTarget 의 handler 는 동시에 실행되지 않으므로 잠금 없이 기록
+		eventDispatcher.registerEventHandler(1, eventTargets.back(), [&received, i](ev::Event& event) { received[i].push_back(test::valueOf(event)); });
+	}
+
+	{
+		ev::target::StrandEventDispatcher<> strandEventDispatcher{ eventDispatcher, executor };
+		for (int value = 0; value < 500; value++)
+		{
+			for (auto const& eventTarget : eventTargets)
+			{
+				strandEventDispatcher.postEvent(1, eventTarget, ev::makeEventData<test::ValueData>(value));
+			}
+		}
+		strandEventDispatcher.flush();
+	}
+
+	for (auto const& values : received)
+	{
+		CX_EV_CHECK(values.size() == 500);
+		CX_EV_CHECK(std::is_sorted(values.begin(), values.end()));
+	}
+}
+
+CX_EV_TEST(strandPrunedWhenDrained)
+{
+	ev::WorkStealingExecutor executor{ 2 };
+	std::atomic<int> count{ 0 };
+	ev::target::EventStrands eventStrands{ executor, [&count](ev::PostedEvent&) { count++; } };
+
+	std::vector<ev::target::EventTarget> eventTargets;
+	for (int i = 0; i < 100; i++)
+	{
+		eventTargets.push_back(std::make_shared<int>(i));
+		eventStrands.post(ev::PostedEvent{ 1, eventTargets.back(), nullptr });
+	}
+
+	// flush() 없이도 처리가 끝난 strand 는 표에서 빠짐
+	for (int i = 0; i < 10000 && eventStrands.strandCount() != 0; i++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	CX_EV_CHECK(count.load() == 100);
+	CX_EV_CHECK(eventStrands.strandCount() == 0);
+}
+
+
+
+
+
+#if defined(CX_EV_INSTRUMENTATION)
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+// instrumentation
+CX_EV_TEST(instrumentationKeepsExitedThreadsAndCapsTargets)
+{
+	ev::Instrumentation::reset();
+
+	ev::target::EventDispatcher eventDispatcher;
+	ev::target::EventHandlerRegistry eventHandlerRegistry{ eventDispatcher };
+	std::vector<std::shared_ptr<int>> objects;
+	for (std::size_t i = 0; i < ev::Instrumentation::MaxEventTargetCount + 10; i++)
+	{
+		objects.push_back(std::make_shared<int>(0));
+		eventHandlerRegistry.registerEventHandler(1, objects.back(), [](ev::Event&) {});
+	}
+
+	// thread 가 끝난 뒤에도 그 thread 의 기록이 남음
+	std::thread recorder{
+		[&]()
+		{
+			for (auto const& object : objects)
+			{
+				eventDispatcher.notifyEvent(1, object, nullptr);
+			}
+		}
+	};
+	recorder.join();
+
+	auto const snapshot = ev::Instrumentation::snapshot();
+	CX_EV_CHECK(snapshot.eventTypes.at(1).dispatchCount == objects.size());
+	CX_EV_CHECK(snapshot.eventTargets.size() == ev::Instrumentation::MaxEventTargetCount);
+	CX_EV_CHECK(snapshot.otherEventTargets.dispatchCount == 10);
+	CX_EV_CHECK(snapshot.dispatchLatency.totalCount() == objects.size());
+
+	ev::Instrumentation::reset();
+	CX_EV_CHECK(ev::Instrumentation::snapshot().eventTypes.empty());
+}
+#endif
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+//===========================================================================
+int main()
+{
+	for (auto const& testCase : test::testCases())
+	{
+		std::size_t const failureCount = test::_FailureCount;
+		testCase.function();
+		std::cout << (failureCount == test::_FailureCount ? "[ OK   ] " : "[ FAIL ] ") << testCase.name << std::endl;
+	}
+
+	std::cout << test::testCases().size() << " tests, " << test::_FailureCount << " failures" << std::endl;
+	return test::_FailureCount ? 1 : 0;
+}